@@ -0,0 +1,426 @@
+#ifndef COROUTINE_HPP
+#define COROUTINE_HPP
+
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "../mempool/mempool.hpp"
+
+namespace g {
+
+//==========================================
+// Coroutine frame allocator
+//
+// Frames are drawn from size-classed MemPools; sized operator delete lets us find the class
+// again without a header. Frames may be destroyed on another thread than they were created on,
+// so every class has its own lock.
+
+class frame_allocator {
+public:
+    static constexpr size_t MIN_CLASS   = 64;
+    static constexpr size_t CLASS_COUNT = 8;                    // 64 .. 8192 bytes
+    static constexpr size_t MAX_CLASS   = MIN_CLASS << (CLASS_COUNT - 1);
+
+    static void* allocate(size_t size)
+    {
+        if (size > MAX_CLASS)
+            return ::operator new(size);
+        size_class &cls = instance().classes[class_of(size)];
+        std::lock_guard<std::mutex> lock(cls.mutex);
+        return cls.pool.allocate(cls.pool.objsize());
+    }
+
+    static void deallocate(void *ptr, size_t size)
+    {
+        if (size > MAX_CLASS) {
+            ::operator delete(ptr);
+            return;
+        }
+        size_class &cls = instance().classes[class_of(size)];
+        std::lock_guard<std::mutex> lock(cls.mutex);
+        cls.pool.deallocate(ptr);
+    }
+
+private:
+    struct size_class {
+        explicit size_class(size_t objsize) : mutex(), pool(objsize, 64) {}
+
+        std::mutex mutex;
+        MemPool pool;
+    };
+
+    struct classes_t {
+        classes_t() : classes{size_class(MIN_CLASS << 0), size_class(MIN_CLASS << 1), size_class(MIN_CLASS << 2),
+                              size_class(MIN_CLASS << 3), size_class(MIN_CLASS << 4), size_class(MIN_CLASS << 5),
+                              size_class(MIN_CLASS << 6), size_class(MIN_CLASS << 7)} {}
+
+        size_class classes[CLASS_COUNT];
+    };
+
+    static classes_t& instance()
+    {
+        static classes_t classes;
+        return classes;
+    }
+
+    static size_t class_of(size_t size)
+    {
+        size_t cls = 0;
+        while ((MIN_CLASS << cls) < size)
+            ++cls;
+        return cls;
+    }
+};
+
+// Promises derive from it to put their frames into the pools
+struct pooled_promise {
+    static void* operator new(size_t size)              { return frame_allocator::allocate(size); }
+    static void  operator delete(void *ptr, size_t size) { frame_allocator::deallocate(ptr, size); }
+};
+
+//==========================================
+// Generator
+
+template<typename T>
+class generator {
+public:
+    using value_type = std::remove_cvref_t<T>;
+    using reference  = std::conditional_t<std::is_reference_v<T>, T, T&>;
+    using pointer    = std::add_pointer_t<reference>;
+
+    struct promise_type : pooled_promise {
+        pointer value = nullptr;
+        std::exception_ptr error;
+
+        generator get_return_object() { return generator(handle_t::from_promise(*this)); }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend()   noexcept { return {}; }
+
+        std::suspend_always yield_value(std::remove_reference_t<reference> &val) noexcept
+        {
+            value = std::addressof(val);
+            return {};
+        }
+
+        std::suspend_always yield_value(std::remove_reference_t<reference> &&val) noexcept
+        {
+            value = std::addressof(val);
+            return {};
+        }
+
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+
+        template<typename U>
+        std::suspend_never await_transform(U &&value) = delete;     // generators are synchronous
+    };
+
+    using handle_t = std::coroutine_handle<promise_type>;
+
+    struct sentinel {};
+
+    struct Iterator {
+        using iterator_category = std::input_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = generator::value_type;
+        using reference         = generator::reference;
+        using pointer           = generator::pointer;
+
+        Iterator( handle_t handle = nullptr ) : handle_(handle) {}
+
+        bool operator==( sentinel ) const { return !handle_ || handle_.done(); }
+        bool operator!=( sentinel s ) const { return !(*this == s); }
+
+        reference operator*() const { return static_cast<reference>(*handle_.promise().value); }
+        pointer operator->() const  { return handle_.promise().value; }
+
+        Iterator& operator++()
+        {
+            handle_.resume();
+            rethrow();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        void rethrow() const
+        {
+            if (handle_.done() && handle_.promise().error)
+                std::rethrow_exception(handle_.promise().error);
+        }
+
+    private:
+        handle_t handle_;
+    };
+
+    generator() : handle_(nullptr) {}
+    generator( const generator &other ) = delete;
+    generator( generator &&other ) : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    generator& operator=( const generator &other ) = delete;
+    generator& operator=( generator &&other )
+    {
+        if (this != &other) {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~generator() { if (handle_) handle_.destroy(); }
+
+    // WARNING: single pass, begin() starts the coroutine
+    Iterator begin()
+    {
+        Iterator it(handle_);
+        if (handle_) {
+            handle_.resume();
+            it.rethrow();
+        }
+        return it;
+    }
+
+    sentinel end() { return {}; }
+
+private:
+    explicit generator( handle_t handle ) : handle_(handle) {}
+
+    handle_t handle_;
+};
+
+//==========================================
+// Task
+//
+// Lazily started; awaiting a task starts it and resumes the awaiter from its final suspend.
+
+template<typename T = void>
+class task;
+
+namespace detail {
+
+template<typename T>
+struct task_promise_base : pooled_promise {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct final_awaiter {
+        bool await_ready() noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            return handle.promise().continuation;
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    final_awaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template<typename T>
+struct task_promise : task_promise_base<T> {
+    std::optional<T> value;
+
+    task<T> get_return_object();
+
+    template<typename U>
+    void return_value(U &&val) { value.emplace(std::forward<U>(val)); }
+
+    T result()
+    {
+        if (this->error)
+            std::rethrow_exception(this->error);
+        return std::move(*value);
+    }
+};
+
+template<>
+struct task_promise<void> : task_promise_base<void> {
+    task<void> get_return_object();
+
+    void return_void() {}
+
+    void result()
+    {
+        if (this->error)
+            std::rethrow_exception(this->error);
+    }
+};
+
+} // namespace detail
+
+template<typename T>
+class task {
+public:
+    using promise_type = detail::task_promise<T>;
+    using handle_t     = std::coroutine_handle<promise_type>;
+
+    task() : handle_(nullptr) {}
+    explicit task( handle_t handle ) : handle_(handle) {}
+    task( const task &other ) = delete;
+    task( task &&other ) : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    task& operator=( const task &other ) = delete;
+    task& operator=( task &&other )
+    {
+        if (this != &other) {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~task() { if (handle_) handle_.destroy(); }
+
+    bool done() const { return !handle_ || handle_.done(); }
+
+    auto operator co_await() && noexcept
+    {
+        struct awaiter {
+            handle_t handle;
+
+            bool await_ready() noexcept { return handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().result(); }
+        };
+        assert(handle_);
+        return awaiter{handle_};
+    }
+
+private:
+    handle_t handle_;
+};
+
+namespace detail {
+
+template<typename T>
+task<T> task_promise<T>::get_return_object() { return task<T>(std::coroutine_handle<task_promise<T>>::from_promise(*this)); }
+
+inline task<void> task_promise<void>::get_return_object() { return task<void>(std::coroutine_handle<task_promise<void>>::from_promise(*this)); }
+
+struct sync_wait_task {
+    struct promise_type : pooled_promise {
+        std::atomic<bool> finished = false;
+
+        sync_wait_task get_return_object() { return sync_wait_task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct final_awaiter {
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+            {
+                handle.promise().finished.store(true);
+                handle.promise().finished.notify_all();
+            }
+            void await_resume() noexcept {}
+        };
+
+        final_awaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit sync_wait_task( std::coroutine_handle<promise_type> handle ) : handle(handle) {}
+    ~sync_wait_task() { handle.destroy(); }
+
+    void run()
+    {
+        handle.resume();
+        handle.promise().finished.wait(false);
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+} // namespace detail
+
+// Blocks the calling thread until the task is complete and returns its result
+template<typename T>
+T sync_wait(task<T> &&t)
+{
+    std::optional<std::conditional_t<std::is_void_v<T>, char, T>> result;
+    std::exception_ptr error;
+
+    auto waiter = [&]() -> detail::sync_wait_task {
+        try {
+            if constexpr (std::is_void_v<T>)
+                co_await std::move(t);
+            else
+                result.emplace(co_await std::move(t));
+        } catch (...) {
+            error = std::current_exception();
+        }
+    };
+
+    waiter().run();
+    if (error)
+        std::rethrow_exception(error);
+    if constexpr (!std::is_void_v<T>)
+        return std::move(*result);
+}
+
+//==========================================
+// Container adaptors
+
+// Lazily yields the elements of any container with begin()/end(): g::vector, g::deque, g::treap, ...
+template<typename Container>
+auto stream(Container &c) -> generator<decltype(*c.begin())>
+{
+    for (auto it = c.begin(); it != c.end(); ++it)
+        co_yield *it;
+}
+
+template<typename T, typename Predicate>
+generator<T> filter(generator<T> gen, Predicate pred)
+{
+    for (auto &&val : gen)
+        if (pred(val))
+            co_yield static_cast<typename generator<T>::reference>(val);
+}
+
+template<typename T, typename FunctionT>
+auto transform(generator<T> gen, FunctionT func) -> generator<std::invoke_result_t<FunctionT&, typename generator<T>::reference>>
+{
+    for (auto &&val : gen)
+        co_yield func(static_cast<typename generator<T>::reference>(val));
+}
+
+template<typename T>
+generator<T> take(generator<T> gen, size_t n)
+{
+    if (n == 0)
+        co_return;
+    for (auto &&val : gen) {
+        co_yield static_cast<typename generator<T>::reference>(val);
+        if (--n == 0)
+            co_return;
+    }
+}
+
+} // namespace g
+#endif
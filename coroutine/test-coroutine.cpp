@@ -0,0 +1,137 @@
+#include "coroutine.hpp"
+#include "../vector/vector.hpp"
+#include "../deque/deque.hpp"
+#include "../treap/treap.hpp"
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+static std::mt19937 rnd(179);
+
+static g::generator<int> iota(int n)
+{
+    for (int i = 0; i < n; ++i)
+        co_yield i;
+}
+
+TEST(Generator, Basics) {
+    std::vector<int> V;
+    for (int x : iota(10))
+        V.push_back(x);
+    EXPECT_EQ(V, std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+    g::generator<int> empty = iota(0);
+    EXPECT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(Generator, Exceptions) {
+    auto failing = []() -> g::generator<int> {
+        co_yield 1;
+        throw std::runtime_error("generator failed");
+    };
+    auto gen = failing();
+    auto it = gen.begin();
+    EXPECT_EQ(*it, 1);
+    EXPECT_THROW(++it, std::runtime_error);
+}
+
+TEST(Generator, Adaptors) {
+    std::vector<int> V;
+    for (int x : g::take(g::transform(g::filter(iota(1000), [](int x) { return x % 3 == 0; }),
+                                      [](int x) { return x * x; }), 5))
+        V.push_back(x);
+    EXPECT_EQ(V, std::vector<int>({0, 9, 36, 81, 144}));
+}
+
+TEST(Generator, Containers) {
+    g::vector<int> V;
+    g::deque<int> D;
+    g::treap<int, int> T;
+    std::map<int, int> M;
+    for (int i = 0; i < 1000; ++i){
+        int a = rnd();
+        V.push_back(a);
+        D.push_back(a);
+        D.push_front(-a);
+        T.insert(a, i);
+        M[a] = i;
+    }
+
+    size_t i = 0;
+    for (int &x : g::stream(V)){
+        EXPECT_EQ(x, V[i++]);
+        ++x;
+    }
+    EXPECT_EQ(i, V.size());
+    EXPECT_EQ(V[0], *V.begin());
+
+    i = 0;
+    for (const int &x : g::stream(D))
+        EXPECT_EQ(x, D[i++]);
+    EXPECT_EQ(i, D.size());
+
+    auto it = M.begin();
+    for (auto [key, val] : g::stream(T)){
+        EXPECT_EQ(key, it->first);
+        EXPECT_EQ(val, it->second);
+        ++it;
+    }
+    EXPECT_TRUE(it == M.end());
+}
+
+static g::task<int> add(int a, int b)
+{
+    co_return a + b;
+}
+
+static g::task<int> sum_to(int n)
+{
+    int res = 0;
+    for (int i = 1; i <= n; ++i)
+        res = co_await add(res, i);
+    co_return res;
+}
+
+static g::task<void> append(std::string &out, std::string piece)
+{
+    out += piece;
+    co_return;
+}
+
+TEST(Task, Chaining) {
+    EXPECT_EQ(g::sync_wait(sum_to(10000)), 10000 * 10001 / 2);
+
+    std::string out;
+    g::sync_wait([&]() -> g::task<void> {
+        co_await append(out, "co");
+        co_await append(out, "routine");
+    }());
+    EXPECT_EQ(out, "coroutine");
+
+    auto failing = []() -> g::task<int> {
+        throw std::runtime_error("task failed");
+        co_return 0;
+    };
+    EXPECT_THROW(g::sync_wait(failing()), std::runtime_error);
+}
+
+TEST(Task, FramesFromOtherThreads) {
+    std::vector<std::thread> threads;
+    std::atomic<long long> total(0);
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&]() {
+            for (int k = 0; k < 200; ++k)
+                total += g::sync_wait(sum_to(100));
+        });
+    for (auto &t : threads)
+        t.join();
+    EXPECT_EQ(total.load(), 4 * 200 * 5050);
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -340,6 +340,7 @@ template<typename T>
 void deque<T>::push_back(const T &val) {
     refit();
     if (!size_){
+        begin_ = end_ = 0;              // tips may point anywhere after the deque was emptied by pops
         data[0] = val;
     }
     else {
@@ -376,6 +377,7 @@ template<typename T>
 void deque<T>::push_front(const T &val) {
     refit();
     if (!size_){
+        begin_ = end_ = 0;              // tips may point anywhere after the deque was emptied by pops
         data[0] = val;
     }
     else {
@@ -351,6 +351,30 @@ TEST(Iterators, RandomAccessIterator){
 }
 
 
+TEST(Basics, RefillAfterEmpty)
+{
+    std::deque<int> STD1;
+    g::deque<int> D1;
+    for (int k = 0; k < 100; ++k){
+        for (int i = 0; i < rnd() % 10 + 1; ++i){
+            int a = rnd();
+            if (rnd() % 2){
+                D1.push_back(a);
+                STD1.push_back(a);
+            }
+            else{
+                D1.push_front(a);
+                STD1.push_front(a);
+            }
+        }
+        EXPECT_EQ(D1, STD1);
+        while (STD1.size()){
+            EXPECT_EQ(D1.pop_front(), STD1.front());
+            STD1.pop_front();
+        }
+    }
+}
+
 int main(int argc, char* argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <cassert>
+#include <cstdint>
 #include <memory>
+#include <new>
+#include <utility>
+
+#include "../mempool/mempool.hpp"
 
 namespace g {
 
@@ -15,12 +21,46 @@ public:
     function() : holder() {}
 
     template<typename FunctionT>
-    function(FunctionT func) : holder(new func_holder<FunctionT>(func)) {}
+    function(FunctionT func) : holder(new func_holder<FunctionT>(std::move(func))) {}
+
+    // Out-of-line storage is taken from the pool instead of the general-purpose heap when
+    // the wrapped callable fits pool.objsize() and the slot is aligned for it; otherwise
+    // the callable goes to the heap as with the plain constructor.
+    template<typename FunctionT>
+    function(FunctionT func, MemPool &pool) : holder(nullptr, holder_deleter{&pool})
+    {
+        void *mem = nullptr;
+        if (sizeof(func_holder<FunctionT>) <= pool.objsize()) {
+            mem = pool.allocate(pool.objsize());
+            if (reinterpret_cast<uintptr_t>(mem) % alignof(func_holder<FunctionT>) != 0) {
+                pool.deallocate(mem);
+                mem = nullptr;
+            }
+        }
+        if (mem == nullptr) {
+            holder.get_deleter().pool = nullptr;
+            holder.reset(new func_holder<FunctionT>(std::move(func)));
+            return;
+        }
+
+        try {
+            holder.reset(new(mem) func_holder<FunctionT>(std::move(func)));
+        } catch (...) {
+            pool.deallocate(mem);
+            throw;
+        }
+    }
 
     Ret operator()(Args... args) {
         return holder->call(args...);
     }
 
+    explicit operator bool() const { return holder != nullptr; }
+
+    // Size class a pool needs to hold FunctionT wrapped into g::function
+    template<typename FunctionT>
+    static constexpr size_t holder_size() { return sizeof(func_holder<FunctionT>); }
+
 private:
     class func_holder_base {
     public:
@@ -32,7 +72,7 @@ private:
     template<typename FunctionT>
     class func_holder : public func_holder_base {
     public:
-        func_holder(FunctionT func) : func_holder_base(), callee(func) {}
+        func_holder(FunctionT func) : func_holder_base(), callee(std::move(func)) {}
         Ret call(Args... args)
         {
             return callee(args...);
@@ -41,7 +81,21 @@ private:
         FunctionT callee;
     };
 
-    std::unique_ptr<func_holder_base> holder;
+    struct holder_deleter {
+        MemPool *pool = nullptr;
+
+        void operator()(func_holder_base *ptr) const
+        {
+            if (pool == nullptr) {
+                delete ptr;
+                return;
+            }
+            ptr->~func_holder_base();
+            pool->deallocate(ptr);
+        }
+    };
+
+    std::unique_ptr<func_holder_base, holder_deleter> holder;
 };
 
 } /* namespace g */
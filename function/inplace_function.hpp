@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace g {
+
+template<typename Signature, size_t Capacity = 32, size_t Align = alignof(std::max_align_t)>
+class inplace_function;
+
+// Fixed-capacity sibling of g::function: the callable always lives inside the object,
+// callables that do not fit into Capacity bytes are rejected at compile time, so it never allocates.
+template<typename Ret, typename ...Args, size_t Capacity, size_t Align>
+class inplace_function<Ret(Args...), Capacity, Align> {
+public:
+    inplace_function() : ops(nullptr) {}
+
+    template<typename FunctionT,
+             typename = std::enable_if_t<!std::is_same_v<std::decay_t<FunctionT>, inplace_function>>>
+    inplace_function(FunctionT &&func) : ops(&func_ops<std::decay_t<FunctionT>>::table)
+    {
+        using CalleeT = std::decay_t<FunctionT>;
+        static_assert(sizeof(CalleeT) <= Capacity, "callable does not fit into inplace_function storage");
+        static_assert(Align % alignof(CalleeT) == 0, "callable is overaligned for inplace_function storage");
+        static_assert(std::is_copy_constructible_v<CalleeT>, "inplace_function requires a copyable callable");
+        new(storage) CalleeT(std::forward<FunctionT>(func));
+    }
+
+    inplace_function(const inplace_function &other) : ops(other.ops)
+    {
+        if (ops)
+            ops->copy(storage, other.storage);
+    }
+
+    inplace_function(inplace_function &&other) : ops(other.ops)
+    {
+        if (ops)
+            ops->move(storage, other.storage);
+    }
+
+    inplace_function& operator=(const inplace_function &other)
+    {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops)
+                ops->copy(storage, other.storage);
+        }
+        return *this;
+    }
+
+    inplace_function& operator=(inplace_function &&other)
+    {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops)
+                ops->move(storage, other.storage);
+        }
+        return *this;
+    }
+
+    ~inplace_function() { reset(); }
+
+    Ret operator()(Args... args) {
+        assert(ops);
+        return ops->call(storage, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const { return ops != nullptr; }
+
+    void reset()
+    {
+        if (ops)
+            ops->destroy(storage);
+        ops = nullptr;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    struct func_ops_table {
+        Ret  (*call)(void *callee, Args&&... args);
+        void (*copy)(void *dst, const void *src);
+        void (*move)(void *dst, void *src);
+        void (*destroy)(void *callee);
+    };
+
+    template<typename FunctionT>
+    struct func_ops {
+        static Ret call(void *callee, Args&&... args)
+        {
+            return (*static_cast<FunctionT*>(callee))(std::forward<Args>(args)...);
+        }
+
+        static void copy(void *dst, const void *src)
+        {
+            new(dst) FunctionT(*static_cast<const FunctionT*>(src));
+        }
+
+        static void move(void *dst, void *src)
+        {
+            new(dst) FunctionT(std::move(*static_cast<FunctionT*>(src)));
+        }
+
+        static void destroy(void *callee)
+        {
+            static_cast<FunctionT*>(callee)->~FunctionT();
+        }
+
+        static constexpr func_ops_table table = { call, copy, move, destroy };
+    };
+
+    alignas(Align) unsigned char storage[Capacity];
+    const func_ops_table *ops;
+};
+
+} /* namespace g */
@@ -1,5 +1,6 @@
 #include <iostream>
 #include "function.hpp"
+#include "inplace_function.hpp"
 
 int sum(int a, int b)
 {
@@ -24,4 +25,29 @@ int main()
     f = pow;
 
     std::cout << f(2, 3) << std::endl;
+
+    int base = 10;
+    g::inplace_function<int(int, int), 16> h = [base](int a, int b) { return base + a * b; };
+
+    std::cout << h(2, 3) << std::endl;
+
+    g::inplace_function<int(int, int), 16> h_copy = h;
+    h = sum;
+
+    std::cout << h(2, 3) << ' ' << h_copy(2, 3) << std::endl;
+
+    long weights[16] = {1, 2, 3};
+    auto weighted = [weights](int a, int b) { return static_cast<int>(weights[0] * a + weights[2] * b); };
+
+    g::MemPool pool(g::function<int(int, int)>::holder_size<decltype(weighted)>(), 4);
+    for (int i = 0; i < 8; ++i) {
+        g::function<int(int, int)> p(weighted, pool);
+        std::cout << p(i, 3) << ' ';
+    }
+    std::cout << std::endl;
+
+    long more_weights[64] = {4, 5, 6};
+    auto heavy = [more_weights](int a, int b) { return static_cast<int>(more_weights[0] * a + more_weights[2] * b); };
+    g::function<int(int, int)> q(heavy, pool);             // too big for the pool, lands on the heap
+    std::cout << q(1, 3) << std::endl;
 }
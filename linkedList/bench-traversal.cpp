@@ -0,0 +1,75 @@
+#include "linkedlist.hpp"
+#include "unrolledlist.hpp"
+#include "../vector/vector.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Usage: traversal-bench [elements = 1000000] [passes = 20]
+// Lists are built with random positional churn first, so list nodes end up scattered over the pool.
+
+template<typename Container>
+static void bench(const char *name, const Container &c, size_t passes)
+{
+    long long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t p = 0; p < passes; ++p)
+        for (auto it = c.begin(); it != c.end(); ++it)
+            sum += *it;
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-14s %8.2f ns/elem   (checksum %lld)\n", name, time * 1e9 / (double(passes) * c.size()), sum);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n      = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t passes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+
+    std::mt19937 rnd(179);
+    g::list<int> L;
+    g::unrolled_list<int, 64> U;
+    g::vector<int> V;
+
+    for (size_t i = 0; i < n; ++i){
+        int a = rnd() % 1000;
+        L.push_back(a);
+        U.push_back(a);
+        V.push_back(a);
+    }
+
+    // churn: move random elements to random places, which scatters list nodes over the pool
+    auto it = L.begin();
+    auto u_it = U.begin();
+    for (size_t i = 0; i < n; ++i){
+        if (rnd() % 64 == 0){
+            it = L.begin();
+            u_it = U.begin();
+        }
+        ++it;
+        ++u_it;
+        if (it == L.end()){
+            it = L.begin();
+            u_it = U.begin();
+        }
+        int a = *it;
+        it = L.erase(it);
+        u_it = U.erase(u_it);
+        if (it == L.end()){
+            it = L.begin();
+            u_it = U.begin();
+        }
+        size_t skip = rnd() % 16;
+        for (size_t j = 0; j < skip && it != L.end(); ++j){
+            ++it;
+            ++u_it;
+        }
+        it = L.insert(it, a);
+        u_it = U.insert(u_it, a);
+    }
+
+    printf("elements %zu, passes %zu\n", n, passes);
+    bench("g::vector", V, passes);
+    bench("g::unrolled", U, passes);
+    bench("g::list", L, passes);
+}
@@ -3,6 +3,10 @@
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
 
 
 namespace g {
@@ -94,6 +98,29 @@ public:
         last_free = id;
     }
 
+    size_t slots() const { return capacity; }
+
+    // Moves the count live objects reached by walking next_of() from first into slots 0..count-1
+    // of a fresh buffer, in walk order; the remaining slots become the free list
+    template<typename NextF>
+    void relinearize(size_t first, size_t count, NextF next_of)
+    {
+        Node *nbuf = new Node[capacity];
+        size_t id = first;
+        for (size_t i = 0; i < count; ++i) {
+            size_t next = next_of(data[id].val);
+            nbuf[i].val = std::move(data[id].val);
+            id = next;
+        }
+        for (size_t i = count; i + 1 < capacity; ++i)
+            nbuf[i].next = i + 1;
+        nbuf[capacity - 1].next = -1;
+        last_free = (count < capacity ? count : -1);
+
+        delete [] data;
+        data = nbuf;
+    }
+
     void print(std::ostream& out)
     {
         for (size_t id = last_free; id != -1; id = data[id].next)
@@ -139,11 +166,13 @@ class list {
 public:
     struct Node{
         size_t next_;
+        size_t prev_;
         T val_;
     };
 
 private:
     size_t head_;
+    size_t tail_;
     size_t size_;
     ObjPool<Node> pool;
 
@@ -151,19 +180,78 @@ public:
     //===================================
     //  Interface functions
 
-    list() : head_(-1), size_(0) {}
+    list() : head_(-1), tail_(-1), size_(0) {}
     list( const list &other ) = default;
-    list( list &&other ) : head_(other.head_), size_(other.size_) { pool = std::move(other.pool); other.head_ = -1; other.size_ = 0; }
+    list( list &&other ) : head_(other.head_), tail_(other.tail_), size_(other.size_) { pool = std::move(other.pool); other.head_ = other.tail_ = -1; other.size_ = 0; }
 
-    list& operator=( const list &other ) { head_ = other.head_; size_ = other.size_; pool = other.pool; return *this; }
-    list& operator=( list &&other )  { head_ = other.head_; size_ = other.size_; pool = std::move(other.pool); other.head_ = -1; other.size_ = 0; return *this; }
+    list& operator=( const list &other ) { head_ = other.head_; tail_ = other.tail_; size_ = other.size_; pool = other.pool; return *this; }
+    list& operator=( list &&other )  { head_ = other.head_; tail_ = other.tail_; size_ = other.size_; pool = std::move(other.pool); other.head_ = other.tail_ = -1; other.size_ = 0; return *this; }
 
 
     void insert( const T &val ) { insert(0, val); };
     void insert( size_t n, const T &val );
     T erase( size_t n = 0 );
 
+    template<bool Const>
+    struct basic_iterator;
+    using Iterator      = basic_iterator<false>;
+    using ConstIterator = basic_iterator<true>;
+
+    //===================================
+    //  O(1) iterator-based modifiers, pos must point to an element of this list
+
+    template<typename ...Args>
+    T& emplace_front( Args&&... args );
+    void push_front( const T &val ) { emplace_front(val); }
+    T pop_front() { assert(size_); T result = pool.get(head_)->val_; erase(begin()); return result; }
+
+    template<typename ...Args>
+    T& emplace_back( Args&&... args );
+    void push_back( const T &val ) { emplace_back(val); }
+    T pop_back() { assert(size_); T result = pool.get(tail_)->val_; erase(Iterator(tail_, this)); return result; }
+
+    // Inserts before pos, pos may be end()
+    Iterator insert( ConstIterator pos, const T &val ) { return emplace(pos, val); }
+    template<typename ...Args>
+    Iterator emplace( ConstIterator pos, Args&&... args );
+
+    Iterator insert_after( ConstIterator pos, const T &val ) { return emplace_after(pos, val); }
+    template<typename ...Args>
+    Iterator emplace_after( ConstIterator pos, Args&&... args );
+
+    // Both return iterator to the element that followed the erased one
+    Iterator erase( ConstIterator pos );
+    Iterator erase_after( ConstIterator pos );
+
+    // Moves all elements of other after pos; O(1) when other is this list, otherwise nodes are
+    // moved into this list's pool one by one, O(other.size())
+    void splice_after( ConstIterator pos, list &other );
+    // Moves the element following it from other after pos
+    void splice_after( ConstIterator pos, list &other, ConstIterator it );
+
     size_t size() const { return size_; }
+    size_t capacity() const { return pool.slots(); }
+
+    // Rewrites the pool so that list order matches memory order, O(n) with one scratch buffer
+    void relinearize();
+
+    // Stable bottom-up merge sort, O(n log n); only node links are rewritten, payloads never move
+    template<typename Compare = std::less<T>>
+    void sort( Compare cmp = Compare() );
+
+    // Merges sorted other into this sorted list, leaving other empty. Payloads of other are moved
+    // into this list's pool, since the two lists do not share nodes.
+    template<typename Compare = std::less<T>>
+    void merge( list &other, Compare cmp = Compare() );
+
+    // Removes all but the first of every run of equal consecutive elements, returns the number removed
+    template<typename BinaryPredicate = std::equal_to<T>>
+    size_t unique( BinaryPredicate eq = BinaryPredicate() );
+
+    T& front() { assert(size_); return pool.get(head_)->val_; }
+    T& back()  { assert(size_); return pool.get(tail_)->val_; }
+    const T& front() const { assert(size_); return pool.get(head_)->val_; }
+    const T& back()  const { assert(size_); return pool.get(tail_)->val_; }
 
     template<class Container>
     bool operator==( const Container &other ) const;
@@ -178,89 +266,367 @@ public:
     //===================================
     //  Iterators
 
-    struct Iterator {
-        using iterator_category = std::forward_iterator_tag;
+    template<bool Const>
+    struct basic_iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
         using difference_type   = std::ptrdiff_t;
-        using value_type        = Node;
+        using value_type        = T;
+        using pointer           = std::conditional_t<Const, const T*, T*>;
+        using reference         = std::conditional_t<Const, const T&, T&>;
+        using list_pointer      = std::conditional_t<Const, const list*, list*>;
+
+        basic_iterator( size_t id = -1, list_pointer list = nullptr ) : list_(list), id_(id) {};
+        basic_iterator( const basic_iterator &other ) = default;
+        basic_iterator& operator=( const basic_iterator &other ) = default;
 
-        Iterator( size_t id = -1, const ObjPool<Node> *pool = nullptr ) : pool_(pool), id_(id) {};
-        Iterator( const Iterator &other ) = default;
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator( const basic_iterator<false> &other ) : list_(other.list_), id_(other.id_) {}
 
-        bool operator==( const Iterator &other ) const { return id_ == other.id_; }
-        bool operator!=( const Iterator &other ) const { return id_ != other.id_; }
+        bool operator==( const basic_iterator &other ) const { return id_ == other.id_; }
+        bool operator!=( const basic_iterator &other ) const { return id_ != other.id_; }
 
-        T operator*() { assert(id_ != -1); return pool_->get(id_)->val_; }
-        const T operator*() const { assert(id_ != -1); return pool_->get(id_)->val_; }
+        reference operator*()  const { assert(id_ != -1); return list_->pool.get(id_)->val_; }
+        pointer   operator->() const { assert(id_ != -1); return &list_->pool.get(id_)->val_; }
 
-        Iterator operator++() {
-            id_ = pool_->get(id_)->next_;
+        basic_iterator& operator++() {
+            id_ = list_->pool.get(id_)->next_;
             return *this;
         }
 
-        Iterator operator++(int) {
-            Iterator result(*this);
-            id_ = pool_->get(id_)->next_;
+        basic_iterator operator++(int) {
+            basic_iterator result(*this);
+            id_ = list_->pool.get(id_)->next_;
+            return result;
+        }
+
+        basic_iterator& operator--() {
+            id_ = (id_ == -1 ? list_->tail_ : list_->pool.get(id_)->prev_);
+            return *this;
+        }
+
+        basic_iterator operator--(int) {
+            basic_iterator result(*this);
+            id_ = (id_ == -1 ? list_->tail_ : list_->pool.get(id_)->prev_);
             return result;
         }
 
 
     private:
-        const ObjPool<Node> *pool_;
+        list_pointer list_;
         size_t id_;
 
+        friend class list;
+        template<bool> friend struct basic_iterator;
     };
 
-    Iterator begin() const { return Iterator(head_, &pool); }
-    Iterator end()   const { return Iterator(   -1, &pool); }
+    using iterator       = Iterator;
+    using const_iterator = ConstIterator;
+
+    Iterator begin() { return Iterator(head_, this); }
+    Iterator end()   { return Iterator(   -1, this); }
+
+    ConstIterator begin() const { return ConstIterator(head_, this); }
+    ConstIterator end()   const { return ConstIterator(   -1, this); }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend()   const { return end(); }
+
+private:
+    template<typename ...Args>
+    size_t new_node( Args&&... args );
+
+    void link_after( size_t pos_id, size_t id );       // pos_id == -1 links to the front
+    void unlink( size_t id );
+
+    size_t node_at( size_t n ) const;
+
+    template<typename Compare>
+    size_t merge_runs( size_t a, size_t b, Compare &cmp );
 };
 
+template<typename T>
+template<typename ...Args>
+size_t list<T>::new_node(Args&&... args) {
+    size_t id = pool.alloc();
+    pool.get(id)->val_ = T(std::forward<Args>(args)...);
+    return id;
+}
+
+template<typename T>
+void list<T>::link_after(size_t pos_id, size_t id) {
+    Node *v = pool.get(id);
+    v->prev_ = pos_id;
+    if (pos_id == -1) {
+        v->next_ = head_;
+        head_ = id;
+    } else {
+        Node *p = pool.get(pos_id);
+        v->next_ = p->next_;
+        p->next_ = id;
+    }
+    if (v->next_ == -1)
+        tail_ = id;
+    else
+        pool.get(v->next_)->prev_ = id;
+}
+
+template<typename T>
+void list<T>::unlink(size_t id) {
+    Node *v = pool.get(id);
+    if (v->prev_ == -1)
+        head_ = v->next_;
+    else
+        pool.get(v->prev_)->next_ = v->next_;
+    if (v->next_ == -1)
+        tail_ = v->prev_;
+    else
+        pool.get(v->next_)->prev_ = v->prev_;
+}
+
+template<typename T>
+size_t list<T>::node_at(size_t n) const {
+    assert(n < size_);
+    size_t id;
+    if (n < size_ / 2) {
+        id = head_;
+        for (size_t i = 0; i < n; ++i)
+            id = pool.get(id)->next_;
+    } else {
+        id = tail_;
+        for (size_t i = size_ - 1; i > n; --i)
+            id = pool.get(id)->prev_;
+    }
+    return id;
+}
+
+template<typename T>
+template<typename ...Args>
+T& list<T>::emplace_front(Args&&... args) {
+    size_t id = new_node(std::forward<Args>(args)...);
+    link_after(-1, id);
+    ++size_;
+    return pool.get(id)->val_;
+}
+
+template<typename T>
+template<typename ...Args>
+T& list<T>::emplace_back(Args&&... args) {
+    size_t id = new_node(std::forward<Args>(args)...);
+    link_after(tail_, id);
+    ++size_;
+    return pool.get(id)->val_;
+}
+
+template<typename T>
+template<typename ...Args>
+typename list<T>::Iterator list<T>::emplace(ConstIterator pos, Args&&... args) {
+    size_t id = new_node(std::forward<Args>(args)...);
+    link_after(pos.id_ == -1 ? tail_ : pool.get(pos.id_)->prev_, id);
+    ++size_;
+    return Iterator(id, this);
+}
+
+template<typename T>
+template<typename ...Args>
+typename list<T>::Iterator list<T>::emplace_after(ConstIterator pos, Args&&... args) {
+    assert(pos.id_ != -1);
+    size_t id = new_node(std::forward<Args>(args)...);
+    link_after(pos.id_, id);
+    ++size_;
+    return Iterator(id, this);
+}
+
+template<typename T>
+typename list<T>::Iterator list<T>::erase(ConstIterator pos) {
+    assert(pos.id_ != -1);
+    size_t next = pool.get(pos.id_)->next_;
+    unlink(pos.id_);
+    pool.free(pos.id_);
+    --size_;
+    return Iterator(next, this);
+}
+
+template<typename T>
+typename list<T>::Iterator list<T>::erase_after(ConstIterator pos) {
+    assert(pos.id_ != -1);
+    size_t id = pool.get(pos.id_)->next_;
+    assert(id != -1);
+    return erase(Iterator(id, this));
+}
+
+template<typename T>
+void list<T>::splice_after(ConstIterator pos, list &other) {
+    assert(pos.id_ != -1);
+    if (other.head_ == -1)
+        return;
+    if (&other == this)
+        return;
+
+    size_t after = pos.id_;
+    while (other.head_ != -1) {
+        size_t id = new_node(std::move(other.pool.get(other.head_)->val_));
+        other.erase(0);
+        link_after(after, id);
+        after = id;
+        ++size_;
+    }
+}
+
+template<typename T>
+void list<T>::splice_after(ConstIterator pos, list &other, ConstIterator it) {
+    assert(pos.id_ != -1 && it.id_ != -1);
+    if (&other != this) {
+        size_t moved = other.pool.get(it.id_)->next_;
+        assert(moved != -1);
+        emplace_after(pos, std::move(other.pool.get(moved)->val_));
+        other.erase_after(it);
+        return;
+    }
+
+    size_t moved = pool.get(it.id_)->next_;
+    assert(moved != -1);
+    if (moved == pos.id_ || it.id_ == pos.id_)
+        return;
+    unlink(moved);
+    link_after(pos.id_, moved);
+}
+
 template<typename T>
 void list<T>::insert(size_t n, const T &val) {
     assert(n <= size_);
-    ++size_;
     if (n == 0){
-        size_t id = pool.alloc();
-        pool.get(id)->next_ = head_;
-        pool.get(id)->val_ = val;
-        head_ = id;
+        emplace_front(val);
         return;
     }
-    size_t id = head_;
-    for (size_t i = 0; i < n - 1; ++i)
-        id = pool.get(id)->next_;
-
-    size_t new_id = pool.alloc();
-    Node *v = pool.get(id), *new_ = pool.get(new_id);
-    new_->next_ = v->next_;
-    new_->val_ = val;
-    v->next_ = new_id;
+    emplace_after(Iterator(node_at(n - 1), this), val);
 }
 
 template<typename T>
 T list<T>::erase(size_t n) {
     assert(n < size_);
+    size_t result_id = node_at(n);
     --size_;
-    if (n == 0){
-        Node *v = pool.get(head_);
-        head_ = v->next_;
-        return v->val_;
-    }
-    size_t id = head_;
-    for (size_t i = 0; i < n - 1; ++i)
-        id = pool.get(id)->next_;
-    Node *v = pool.get(id);
-    size_t result_id = v->next_;
-    v->next_ = pool.get(result_id)->next_;
+    unlink(result_id);
     T result_val = pool.get(result_id)->val_;
     pool.free(result_id);
     return result_val;
 }
 
+template<typename T>
+void list<T>::relinearize() {
+    if (size_ == 0)
+        return;
+    pool.relinearize(head_, size_, [](const Node &v) { return v.next_; });
+    for (size_t i = 0; i < size_; ++i) {
+        Node *v = pool.get(i);
+        v->prev_ = (i == 0 ? -1 : i - 1);
+        v->next_ = (i + 1 == size_ ? -1 : i + 1);
+    }
+    head_ = 0;
+    tail_ = size_ - 1;
+}
+
+template<typename T>
+template<typename Compare>
+size_t list<T>::merge_runs(size_t a, size_t b, Compare &cmp) {
+    size_t head = -1;
+    size_t *link = &head;                   // the pool is not reallocated while sorting
+    while (a != -1 && b != -1) {
+        Node *va = pool.get(a), *vb = pool.get(b);
+        if (cmp(vb->val_, va->val_)) {
+            *link = b;
+            link = &vb->next_;
+            b = vb->next_;
+        } else {
+            *link = a;
+            link = &va->next_;
+            a = va->next_;
+        }
+    }
+    *link = (a != -1 ? a : b);
+    return head;
+}
+
+template<typename T>
+template<typename Compare>
+void list<T>::sort(Compare cmp) {
+    if (size_ < 2)
+        return;
+
+    size_t bins[64];                        // bins[i] is a sorted run of 2^i nodes or empty
+    std::fill(bins, bins + 64, size_t(-1));
+
+    size_t id = head_;
+    while (id != -1) {
+        Node *v = pool.get(id);
+        size_t next = v->next_;
+        v->next_ = -1;
+
+        size_t run = id, i = 0;
+        for (; bins[i] != -1; ++i) {
+            run = merge_runs(bins[i], run, cmp);
+            bins[i] = -1;
+        }
+        bins[i] = run;
+        id = next;
+    }
+
+    size_t run = -1;
+    for (size_t i = 0; i < 64; ++i)
+        if (bins[i] != -1)
+            run = merge_runs(bins[i], run, cmp);
+
+    head_ = run;
+    size_t prev = -1;
+    for (id = head_; id != -1; id = pool.get(id)->next_) {
+        pool.get(id)->prev_ = prev;
+        prev = id;
+    }
+    tail_ = prev;
+}
+
+template<typename T>
+template<typename Compare>
+void list<T>::merge(list &other, Compare cmp) {
+    if (&other == this)
+        return;
+
+    ConstIterator it = begin();
+    while (other.size_) {
+        T &val = other.front();
+        while (it != end() && !cmp(val, *it))
+            ++it;
+        emplace(it, std::move(val));
+        other.erase(other.begin());
+    }
+}
+
+template<typename T>
+template<typename BinaryPredicate>
+size_t list<T>::unique(BinaryPredicate eq) {
+    size_t removed = 0;
+    if (size_ == 0)
+        return removed;
+
+    Iterator it = begin();
+    Iterator next = it;
+    ++next;
+    while (next != end()) {
+        if (eq(*it, *next)) {
+            next = erase(next);
+            ++removed;
+        } else {
+            it = next++;
+        }
+    }
+    return removed;
+}
+
 template<typename T>
 void list<T>::dump(std::ostream &out) const {
     out << "head = " << head_ << '\n';
+    out << "tail = " << tail_ << '\n';
     out << "size = " << size_ << '\n';
-    for (auto elem : *this)
+    for (const T &elem : *this)
         out << "( " << elem << " ) ";
     out << '\n';
 }
@@ -272,7 +638,7 @@ bool list<T>::operator==(const Container &other) const {
         return false;
     }
 
-    Iterator iter_1 = begin();
+    ConstIterator iter_1 = begin();
     auto iter_2 = other.begin();
     while (iter_1 != end()) {
         if (*iter_1 != *iter_2)
@@ -285,18 +651,12 @@ bool list<T>::operator==(const Container &other) const {
 
 template<typename T>
 T& list<T>::operator[](size_t n) {
-    size_t id = head_;
-    for (size_t i = 0; i < n; ++i)
-        id = pool.get(id)->next_;
-    return pool.get(id)->val_;
+    return pool.get(node_at(n))->val_;
 }
 
 template<typename T>
 const T& list<T>::operator[](size_t n) const {
-    size_t id = head_;
-    for (size_t i = 0; i < n; ++i)
-        id = pool.get(id)->next_;
-    return pool.get(id)->val_;
+    return pool.get(node_at(n))->val_;
 }
 
 } // namespace g
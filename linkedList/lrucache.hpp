@@ -0,0 +1,397 @@
+#ifndef LRUCACHE_HPP
+#define LRUCACHE_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "linkedlist.hpp"
+
+namespace g {
+
+// Default weigher: capacity counts entries
+struct unit_weight {
+    template<typename K, typename V>
+    size_t operator()( const K&, const V& ) const { return 1; }
+};
+
+namespace detail {
+
+//==========================================
+// Cache with O(1) get/put/evict
+//
+// Entries are pooled doubly-linked nodes in recency order (LRU) or in ring order (CLOCK), found
+// through a linear-probing index of node ids that stores the hash next to the id and deletes by
+// backward shift, so there are no tombstones. Capacity is in units of Weigher(key, value).
+// CLOCK only sets a bit on a hit and moves its hand on eviction, so reads never relink nodes.
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+class basic_cache {
+public:
+    using key_type    = K;
+    using mapped_type = V;
+    using hasher      = Hash;
+
+    explicit basic_cache( size_t capacity, Weigher weigher = Weigher(), Hash hash = Hash() );
+
+    // Pointer stays valid until the next put() or erase()
+    V* get ( const K &key );
+    // Like get() but does not count as a use
+    const V* peek( const K &key ) const;
+
+    // Inserts or overwrites key, evicting as needed; false if the entry alone outweighs the capacity
+    bool put  ( const K &key, V val );
+    bool erase( const K &key );
+
+    size_t size()      const { return size_; }
+    size_t weight()    const { return weight_; }
+    size_t capacity()  const { return capacity_; }
+    size_t evictions() const { return evictions_; }
+
+    // Calls func(key, value) from the most to the least recently used entry (LRU) or in hand order (CLOCK)
+    template<typename FunctionT>
+    void for_each( FunctionT func ) const;
+
+private:
+    struct Node {
+        size_t next_;
+        size_t prev_;
+        K key;
+        V val;
+        size_t weight;
+        bool referenced;
+    };
+
+    struct slot {
+        size_t id;
+        size_t hash;
+    };
+
+    ObjPool<Node> pool;
+    std::vector<slot> index;
+    size_t head_, tail_;
+    size_t hand_;                                   // CLOCK: next eviction candidate, -1 means head_
+    size_t size_;
+    size_t weight_;
+    size_t capacity_;
+    size_t evictions_;
+    Weigher weigher;
+    Hash hash_fn;
+
+    size_t hash_of( const K &key ) const
+    {
+        uint64_t h = uint64_t(hash_fn(key)) * 0x9E3779B97F4A7C15ull;
+        return size_t(h ^ (h >> 32));
+    }
+
+    size_t find_slot( const K &key, size_t hash ) const;   // the slot of key or the empty slot to put it in
+    void   erase_slot( size_t i );
+    void   grow_index();
+
+    void link_after( size_t pos_id, size_t id );           // pos_id == -1 links to the front
+    void unlink( size_t id );
+    void remove( size_t slot_id );
+    void evict( size_t keep = -1 );                         // never picks keep
+};
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+basic_cache<K, V, Hash, Weigher, Clock>::basic_cache(size_t capacity, Weigher weigher, Hash hash) :
+    pool(16), index(16, slot{size_t(-1), 0}), head_(-1), tail_(-1), hand_(-1),
+    size_(0), weight_(0), capacity_(capacity), evictions_(0), weigher(weigher), hash_fn(hash)
+{}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+size_t basic_cache<K, V, Hash, Weigher, Clock>::find_slot(const K &key, size_t hash) const {
+    size_t mask = index.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        const slot &s = index[i];
+        if (s.id == -1 || (s.hash == hash && pool.get(s.id)->key == key))
+            return i;
+    }
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+void basic_cache<K, V, Hash, Weigher, Clock>::erase_slot(size_t i) {
+    size_t mask = index.size() - 1;
+    for (size_t j = (i + 1) & mask; index[j].id != -1; j = (j + 1) & mask) {
+        size_t home = index[j].hash & mask;
+        bool stays = (i <= j ? (i < home && home <= j) : (i < home || home <= j));
+        if (!stays) {
+            index[i] = index[j];
+            i = j;
+        }
+    }
+    index[i].id = -1;
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+void basic_cache<K, V, Hash, Weigher, Clock>::grow_index() {
+    std::vector<slot> old(index.size() * 2, slot{size_t(-1), 0});
+    old.swap(index);
+    size_t mask = index.size() - 1;
+    for (const slot &s : old) {
+        if (s.id == -1)
+            continue;
+        size_t i = s.hash & mask;
+        while (index[i].id != -1)
+            i = (i + 1) & mask;
+        index[i] = s;
+    }
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+void basic_cache<K, V, Hash, Weigher, Clock>::link_after(size_t pos_id, size_t id) {
+    Node *v = pool.get(id);
+    v->prev_ = pos_id;
+    if (pos_id == -1) {
+        v->next_ = head_;
+        head_ = id;
+    } else {
+        Node *p = pool.get(pos_id);
+        v->next_ = p->next_;
+        p->next_ = id;
+    }
+    if (v->next_ == -1)
+        tail_ = id;
+    else
+        pool.get(v->next_)->prev_ = id;
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+void basic_cache<K, V, Hash, Weigher, Clock>::unlink(size_t id) {
+    Node *v = pool.get(id);
+    if (Clock && hand_ == id)
+        hand_ = v->next_;
+    if (v->prev_ == -1)
+        head_ = v->next_;
+    else
+        pool.get(v->prev_)->next_ = v->next_;
+    if (v->next_ == -1)
+        tail_ = v->prev_;
+    else
+        pool.get(v->next_)->prev_ = v->prev_;
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+void basic_cache<K, V, Hash, Weigher, Clock>::remove(size_t slot_id) {
+    size_t id = index[slot_id].id;
+    erase_slot(slot_id);
+    unlink(id);
+    Node *v = pool.get(id);
+    weight_ -= v->weight;
+    v->key = K();                                   // don't keep evicted payloads alive in the pool
+    v->val = V();
+    pool.free(id);
+    --size_;
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+void basic_cache<K, V, Hash, Weigher, Clock>::evict(size_t keep) {
+    assert(size_ > (keep != -1));
+    size_t victim = tail_;                          // LRU: keep is at the front, so not the tail
+    if (Clock) {
+        while (true) {
+            if (hand_ == -1)
+                hand_ = head_;
+            Node *v = pool.get(hand_);
+            if (hand_ != keep) {
+                if (!v->referenced) {
+                    victim = hand_;
+                    break;
+                }
+                v->referenced = false;
+            }
+            hand_ = v->next_;
+        }
+    }
+    Node *v = pool.get(victim);
+    remove(find_slot(v->key, hash_of(v->key)));
+    ++evictions_;
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+V* basic_cache<K, V, Hash, Weigher, Clock>::get(const K &key) {
+    size_t id = index[find_slot(key, hash_of(key))].id;
+    if (id == -1)
+        return nullptr;
+    if (Clock) {
+        pool.get(id)->referenced = true;
+    } else if (id != head_) {
+        unlink(id);
+        link_after(-1, id);
+    }
+    return &pool.get(id)->val;
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+const V* basic_cache<K, V, Hash, Weigher, Clock>::peek(const K &key) const {
+    size_t id = index[find_slot(key, hash_of(key))].id;
+    return id == -1 ? nullptr : &pool.get(id)->val;
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+bool basic_cache<K, V, Hash, Weigher, Clock>::put(const K &key, V val) {
+    size_t hash = hash_of(key);
+    size_t w = weigher(key, val);
+    size_t i = find_slot(key, hash);
+
+    if (index[i].id != -1) {
+        if (w > capacity_) {
+            remove(i);
+            return false;
+        }
+        size_t id = index[i].id;
+        Node *v = pool.get(id);
+        weight_ = weight_ - v->weight + w;
+        v->val = std::move(val);
+        v->weight = w;
+        if (Clock) {
+            v->referenced = true;
+        } else if (id != head_) {
+            unlink(id);
+            link_after(-1, id);
+        }
+        while (weight_ > capacity_)                 // w fits, so some other entry is always left to go
+            evict(id);
+        return true;
+    }
+
+    if (w > capacity_)
+        return false;
+    bool evicted = false;
+    while (weight_ + w > capacity_) {
+        evict();
+        evicted = true;
+    }
+    if (2 * (size_ + 1) > index.size()) {
+        grow_index();
+        evicted = true;
+    }
+    if (evicted)
+        i = find_slot(key, hash);
+
+    size_t id = pool.alloc();
+    Node *v = pool.get(id);
+    v->key = key;
+    v->val = std::move(val);
+    v->weight = w;
+    v->referenced = false;
+    if (!Clock)
+        link_after(-1, id);
+    else if (hand_ == -1)
+        link_after(tail_, id);                      // just behind the hand in ring order
+    else
+        link_after(pool.get(hand_)->prev_, id);
+
+    index[i] = slot{id, hash};
+    weight_ += w;
+    ++size_;
+    return true;
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+bool basic_cache<K, V, Hash, Weigher, Clock>::erase(const K &key) {
+    size_t i = find_slot(key, hash_of(key));
+    if (index[i].id == -1)
+        return false;
+    remove(i);
+    return true;
+}
+
+template<typename K, typename V, typename Hash, typename Weigher, bool Clock>
+template<typename FunctionT>
+void basic_cache<K, V, Hash, Weigher, Clock>::for_each(FunctionT func) const {
+    size_t start = (Clock && hand_ != -1 ? hand_ : head_);
+    for (size_t id = start; id != -1; id = pool.get(id)->next_)
+        func(static_cast<const K&>(pool.get(id)->key), static_cast<const V&>(pool.get(id)->val));
+    if (start != head_)
+        for (size_t id = head_; id != start; id = pool.get(id)->next_)
+            func(static_cast<const K&>(pool.get(id)->key), static_cast<const V&>(pool.get(id)->val));
+}
+
+} // namespace detail
+
+template<typename K, typename V, typename Hash = std::hash<K>, typename Weigher = unit_weight>
+using lru_cache = detail::basic_cache<K, V, Hash, Weigher, false>;
+
+template<typename K, typename V, typename Hash = std::hash<K>, typename Weigher = unit_weight>
+using clock_cache = detail::basic_cache<K, V, Hash, Weigher, true>;
+
+//==========================================
+// Sharded cache
+//
+// Splits the capacity evenly between independently locked caches picked by key hash. Values are
+// returned by copy, since a pointer into a shard would outlive its lock.
+
+template<typename Cache, size_t Shards = 16>
+class sharded_cache {
+public:
+    using key_type    = typename Cache::key_type;
+    using mapped_type = typename Cache::mapped_type;
+
+    template<typename ...Args>
+    explicit sharded_cache( size_t capacity, Args&&... args )
+    {
+        for (auto &s : shards)
+            s.reset(new shard((capacity + Shards - 1) / Shards, args...));
+    }
+
+    std::optional<mapped_type> get( const key_type &key )
+    {
+        shard &s = shard_of(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (mapped_type *val = s.cache.get(key))
+            return *val;
+        return std::nullopt;
+    }
+
+    bool put( const key_type &key, mapped_type val )
+    {
+        shard &s = shard_of(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return s.cache.put(key, std::move(val));
+    }
+
+    bool erase( const key_type &key )
+    {
+        shard &s = shard_of(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return s.cache.erase(key);
+    }
+
+    size_t size()
+    {
+        size_t result = 0;
+        for (auto &s : shards) {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            result += s->cache.size();
+        }
+        return result;
+    }
+
+private:
+    struct alignas(64) shard {
+        template<typename ...Args>
+        explicit shard( Args&&... args ) : mutex(), cache(std::forward<Args>(args)...) {}
+
+        std::mutex mutex;
+        Cache cache;
+    };
+
+    std::unique_ptr<shard> shards[Shards];
+    typename Cache::hasher hash_fn;
+
+    shard& shard_of( const key_type &key )
+    {
+        uint64_t h = uint64_t(hash_fn(key)) * 0xC2B2AE3D27D4EB4Full;   // independent of the shard's own index bits
+        return *shards[(h >> 40) % Shards];
+    }
+};
+
+} // namespace g
+#endif
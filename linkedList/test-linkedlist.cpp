@@ -1,5 +1,10 @@
 #include "linkedlist.hpp"
 #include <vector>
+#include <list>
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+#include <string>
 #include <random>
 #include "gtest/gtest.h"
 
@@ -122,6 +127,367 @@ TEST(Basics, copyAndMove){
 }
 
 
+TEST(Iterators, insertAndEraseAfter){
+    for (int k = 0; k < 1000; ++k){
+        g::list<int> L1;
+        std::vector<int> V1;
+        int a = rnd();
+        L1.emplace_front(a);
+        V1.push_back(a);
+
+        auto it = L1.begin();
+        size_t pos = 0;
+        for (size_t i = 0; i < rnd() % 100 + 10; ++i){
+            a = rnd();
+            if (rnd() % 4 == 0){
+                L1.push_front(a);
+                V1.insert(V1.begin(), a);
+                ++pos;
+            }
+            else{
+                it = L1.insert_after(it, a);
+                V1.insert(V1.begin() + ++pos, a);
+            }
+        }
+        EXPECT_EQ(L1, V1);
+
+        it = L1.begin();
+        pos = 0;
+        while (pos + 1 < V1.size()){
+            if (rnd() % 2){
+                auto next = L1.erase_after(it);
+                V1.erase(V1.begin() + pos + 1);
+                if (pos + 1 < V1.size())
+                    EXPECT_EQ(*next, V1[pos + 1]);
+                else
+                    EXPECT_EQ(next, L1.end());
+            }
+            else{
+                ++it;
+                ++pos;
+            }
+        }
+        EXPECT_EQ(L1, V1);
+        EXPECT_EQ(L1.size(), V1.size());
+    }
+}
+
+TEST(Iterators, spliceAfter){
+    for (int k = 0; k < 300; ++k){
+        g::list<int> L1, L2;
+        std::vector<int> V1, V2;
+        for (size_t i = 0; i < rnd() % 50 + 10; ++i){
+            int a = rnd(), b = rnd();
+            L1.insert(a);
+            V1.insert(V1.begin(), a);
+            L2.insert(b);
+            V2.insert(V2.begin(), b);
+        }
+
+        for (int j = 0; j < 20; ++j){           // move one element within the list
+            size_t from = rnd() % (V1.size() - 1), to = rnd() % V1.size();
+            if (to == from || to == from + 1)
+                continue;
+            auto it_from = L1.begin(), it_to = L1.begin();
+            for (size_t i = 0; i < from; ++i) ++it_from;
+            for (size_t i = 0; i < to; ++i)   ++it_to;
+            L1.splice_after(it_to, L1, it_from);
+
+            int moved = V1[from + 1];
+            V1.erase(V1.begin() + from + 1);
+            if (to > from) --to;
+            V1.insert(V1.begin() + to + 1, moved);
+            EXPECT_EQ(L1, V1);
+        }
+
+        auto it = L2.begin();                   // move one element from another list
+        L1.splice_after(L1.begin(), L2, it);
+        V1.insert(V1.begin() + 1, V2[1]);
+        V2.erase(V2.begin() + 1);
+        EXPECT_EQ(L1, V1);
+        EXPECT_EQ(L2, V2);
+
+        size_t pos = rnd() % V1.size();         // move the whole other list
+        it = L1.begin();
+        for (size_t i = 0; i < pos; ++i) ++it;
+        L1.splice_after(it, L2);
+        V1.insert(V1.begin() + pos + 1, V2.begin(), V2.end());
+        EXPECT_EQ(L1, V1);
+        EXPECT_EQ(L2.size(), 0);
+    }
+}
+
+TEST(Doubly, pushAndPopOnBothEnds){
+    for (int k = 0; k < 1000; ++k){
+        g::list<int> L1;
+        std::list<int> S1;
+        for (size_t i = 0; i < rnd() % 200 + 10; ++i){
+            int a = rnd();
+            switch (rnd() % 5) {
+                case 0: L1.push_front(a); S1.push_front(a); break;
+                case 1: L1.push_back(a);  S1.push_back(a);  break;
+                case 2: if (S1.size()) { EXPECT_EQ(L1.pop_back(), S1.back());   S1.pop_back();  } break;
+                case 3: if (S1.size()) { EXPECT_EQ(L1.pop_front(), S1.front()); S1.pop_front(); } break;
+                default: L1.emplace_back(a); S1.emplace_back(a); break;
+            }
+            if (S1.size()){
+                EXPECT_EQ(L1.front(), S1.front());
+                EXPECT_EQ(L1.back(), S1.back());
+            }
+        }
+        EXPECT_EQ(L1, S1);
+        EXPECT_EQ(L1.size(), S1.size());
+    }
+}
+
+TEST(Doubly, bidirectionalIterators){
+    for (int k = 0; k < 300; ++k){
+        g::list<int> L1;
+        std::list<int> S1;
+        for (size_t i = 0; i < rnd() % 200 + 10; ++i){
+            int a = rnd();
+            L1.push_back(a);
+            S1.push_back(a);
+        }
+
+        auto it = L1.end();
+        auto s_it = S1.end();
+        while (s_it != S1.begin()){
+            --it; --s_it;
+            EXPECT_EQ(*it, *s_it);
+        }
+        EXPECT_EQ(it, L1.begin());
+
+        for (size_t j = 0; j < S1.size(); ++j)
+            EXPECT_EQ(L1[j], *std::next(S1.begin(), j));
+    }
+}
+
+TEST(Doubly, insertAndEraseByIterator){
+    for (int k = 0; k < 300; ++k){
+        g::list<int> L1;
+        std::list<int> S1;
+        auto it = L1.end();
+        auto s_it = S1.end();
+        for (size_t i = 0; i < rnd() % 200 + 10; ++i){
+            int a = rnd();
+            it = L1.insert(it, a);
+            s_it = S1.insert(s_it, a);
+            if (rnd() % 3 == 0){
+                ++it;
+                ++s_it;
+            }
+        }
+        EXPECT_EQ(L1, S1);
+
+        it = L1.begin();
+        s_it = S1.begin();
+        while (s_it != S1.end()){
+            if (rnd() % 2){
+                it = L1.erase(it);
+                s_it = S1.erase(s_it);
+            }
+            else{
+                ++it;
+                ++s_it;
+            }
+        }
+        EXPECT_EQ(it, L1.end());
+        EXPECT_EQ(L1, S1);
+        if (S1.size()){
+            EXPECT_EQ(L1.back(), S1.back());
+            EXPECT_EQ(*--L1.end(), S1.back());
+        }
+    }
+}
+
+TEST(Pool, headEraseReusesNodes){
+    g::list<int> L1;
+    for (int i = 0; i < 16; ++i)
+        L1.push_back(i);
+    size_t capacity = L1.capacity();
+    for (int k = 0; k < 10000; ++k){
+        L1.erase(0);
+        L1.insert(L1.size(), k);
+    }
+    EXPECT_EQ(L1.capacity(), capacity);
+    EXPECT_EQ(L1.size(), 16);
+}
+
+TEST(Pool, relinearize){
+    for (int k = 0; k < 100; ++k){
+        g::list<int> L1;
+        std::list<int> S1;
+        for (size_t i = 0; i < rnd() % 500 + 10; ++i){
+            int a = rnd();
+            size_t pos = rnd() % (S1.size() + 1);
+            L1.insert(pos, a);
+            S1.insert(std::next(S1.begin(), pos), a);
+            if (rnd() % 3 == 0){
+                pos = rnd() % S1.size();
+                L1.erase(pos);
+                S1.erase(std::next(S1.begin(), pos));
+            }
+        }
+        if (S1.empty())
+            continue;
+
+        L1.relinearize();
+        EXPECT_EQ(L1, S1);
+        for (size_t j = 0; j + 1 < L1.size(); ++j)
+            EXPECT_LT(&L1[j], &L1[j + 1]);
+
+        for (int j = 0; j < 10; ++j){            // the free list stays usable
+            int a = rnd();
+            L1.push_back(a);
+            S1.push_back(a);
+            L1.pop_front();
+            S1.pop_front();
+        }
+        EXPECT_EQ(L1, S1);
+        EXPECT_EQ(L1.back(), S1.back());
+    }
+}
+
+static_assert(std::bidirectional_iterator<g::list<int>::iterator>);
+static_assert(std::bidirectional_iterator<g::list<int>::const_iterator>);
+static_assert(std::ranges::bidirectional_range<g::list<std::string>>);
+static_assert(std::is_same_v<std::iter_reference_t<g::list<int>::const_iterator>, const int&>);
+
+struct CopyCounter {
+    static inline size_t copies = 0;
+    int val = 0;
+
+    CopyCounter() = default;
+    CopyCounter(int val) : val(val) {}
+    CopyCounter(const CopyCounter &other) : val(other.val) { ++copies; }
+    CopyCounter& operator=(const CopyCounter &other) = default;
+
+    bool operator==(const CopyCounter &other) const { return val == other.val; }
+};
+
+TEST(Iterators, referenceSemantics){
+    g::list<CopyCounter> L1;
+    for (int i = 0; i < 100; ++i)
+        L1.emplace_back(i);
+
+    CopyCounter::copies = 0;
+    int sum = 0;
+    for (const auto &x : L1)
+        sum += x.val;
+    for (auto &x : L1)
+        x.val *= 2;
+    const g::list<CopyCounter> &C1 = L1;
+    for (auto it = C1.begin(); it != C1.end(); ++it)
+        sum += it->val;
+    EXPECT_TRUE(L1 == L1);
+    EXPECT_EQ(CopyCounter::copies, 0);
+    EXPECT_EQ(sum, 99 * 100 / 2 * 3);
+    EXPECT_EQ(L1[10].val, 20);
+}
+
+TEST(Iterators, standardAlgorithms){
+    g::list<std::string> L1;
+    std::vector<std::string> V1;
+    for (int i = 0; i < 200; ++i){
+        std::string a = std::to_string(rnd() % 50);
+        L1.push_back(a);
+        V1.push_back(a);
+    }
+    EXPECT_EQ(std::count(L1.begin(), L1.end(), "7"), std::count(V1.begin(), V1.end(), "7"));
+    EXPECT_EQ(std::distance(L1.cbegin(), std::find(L1.cbegin(), L1.cend(), V1[57])),
+              std::find(V1.begin(), V1.end(), V1[57]) - V1.begin());
+
+    std::ranges::reverse(L1);
+    std::ranges::reverse(V1);
+    EXPECT_EQ(L1, V1);
+
+    auto lengths = L1 | std::views::transform([](const std::string &s) { return s.size(); });
+    size_t total = 0;
+    for (size_t len : lengths)
+        total += len;
+    size_t expected = 0;
+    for (auto &s : V1)
+        expected += s.size();
+    EXPECT_EQ(total, expected);
+
+    g::list<std::string>::const_iterator it = L1.begin();
+    EXPECT_TRUE(it == L1.begin());
+}
+
+struct Record {
+    static inline size_t copies = 0;
+    int key = 0;
+    int payload[32] = {};
+
+    Record() = default;
+    Record(int key, int tag) : key(key) { payload[0] = tag; }
+    Record(const Record &other) : key(other.key) { std::copy(other.payload, other.payload + 32, payload); ++copies; }
+    Record& operator=(const Record &other) = default;
+
+    bool operator==(const Record &other) const { return key == other.key && payload[0] == other.payload[0]; }
+};
+
+TEST(Algorithms, sortIsStableAndDoesNotCopy){
+    for (int k = 0; k < 100; ++k){
+        g::list<Record> L1;
+        std::list<Record> S1;
+        for (int i = 0; i < static_cast<int>(rnd() % 2000); ++i){
+            int a = rnd() % 100;
+            L1.emplace_back(a, i);
+            S1.emplace_back(a, i);
+        }
+        auto by_key = [](const Record &a, const Record &b) { return a.key < b.key; };
+
+        Record::copies = 0;
+        L1.sort(by_key);
+        EXPECT_EQ(Record::copies, 0);
+        S1.sort(by_key);
+        EXPECT_EQ(L1, S1);
+
+        if (S1.size()){
+            EXPECT_EQ(L1.back(), S1.back());
+            auto it = L1.end();
+            for (auto s_it = S1.rbegin(); s_it != S1.rend(); ++s_it)
+                EXPECT_EQ(*--it, *s_it);
+        }
+    }
+
+    g::list<int> L2;
+    for (int i = 0; i < 1000; ++i)
+        L2.push_back(rnd());
+    L2.sort(std::greater<int>());
+    EXPECT_TRUE(std::is_sorted(L2.begin(), L2.end(), std::greater<int>()));
+}
+
+TEST(Algorithms, mergeAndUnique){
+    for (int k = 0; k < 100; ++k){
+        g::list<int> L1, L2;
+        std::list<int> S1, S2;
+        for (size_t i = 0; i < rnd() % 300; ++i){
+            int a = rnd() % 50, b = rnd() % 50;
+            L1.push_back(a);
+            S1.push_back(a);
+            L2.push_back(b);
+            S2.push_back(b);
+        }
+        L1.sort();
+        L2.sort();
+        S1.sort();
+        S2.sort();
+
+        L1.merge(L2);
+        S1.merge(S2);
+        EXPECT_EQ(L1, S1);
+        EXPECT_EQ(L2.size(), 0);
+
+        size_t before = S1.size();
+        S1.unique();
+        EXPECT_EQ(L1.unique(), before - S1.size());
+        EXPECT_EQ(L1, S1);
+    }
+}
+
 int main(int argc, char* argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,209 @@
+#include "lrucache.hpp"
+#include <list>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "gtest/gtest.h"
+
+std::mt19937 rnd(179);
+
+// Reference LRU: front is the most recently used
+struct ModelLRU {
+    size_t capacity;
+    std::list<std::pair<int, int>> order;
+    std::unordered_map<int, std::list<std::pair<int, int>>::iterator> where;
+
+    int* get(int key) {
+        auto it = where.find(key);
+        if (it == where.end())
+            return nullptr;
+        order.splice(order.begin(), order, it->second);
+        return &it->second->second;
+    }
+
+    void put(int key, int val) {
+        if (int *v = get(key)) {
+            *v = val;
+            return;
+        }
+        if (order.size() == capacity) {
+            where.erase(order.back().first);
+            order.pop_back();
+        }
+        order.emplace_front(key, val);
+        where[key] = order.begin();
+    }
+
+    bool erase(int key) {
+        auto it = where.find(key);
+        if (it == where.end())
+            return false;
+        order.erase(it->second);
+        where.erase(it);
+        return true;
+    }
+};
+
+TEST(LRU, MatchesModel)
+{
+    for (int p = 0; p < 10; ++p){
+        size_t capacity = rnd() % 200 + 1;
+        g::lru_cache<int, int> C(capacity);
+        ModelLRU M{capacity, {}, {}};
+        for (int i = 0; i < 20000; ++i){
+            int key = rnd() % 400, val = rnd();
+            switch (rnd() % 4){
+            case 0:
+            case 1: {
+                int *a = C.get(key), *b = M.get(key);
+                ASSERT_EQ(a != nullptr, b != nullptr);
+                if (a){
+                    EXPECT_EQ(*a, *b);
+                }
+                break;
+            }
+            case 2:
+                EXPECT_TRUE(C.put(key, val));
+                M.put(key, val);
+                break;
+            default:
+                EXPECT_EQ(C.erase(key), M.erase(key));
+            }
+            ASSERT_EQ(C.size(), M.order.size());
+        }
+
+        auto it = M.order.begin();
+        C.for_each([&](int key, int val) {
+            EXPECT_EQ(key, it->first);
+            EXPECT_EQ(val, it->second);
+            ++it;
+        });
+        EXPECT_EQ(it, M.order.end());
+    }
+}
+
+TEST(LRU, PeekDoesNotTouch)
+{
+    g::lru_cache<int, int> C(2);
+    C.put(1, 10);
+    C.put(2, 20);
+    EXPECT_EQ(*C.peek(1), 10);
+    C.put(3, 30);
+    EXPECT_EQ(C.peek(1), nullptr);
+    EXPECT_EQ(*C.get(2), 20);
+    C.put(4, 40);
+    EXPECT_EQ(C.peek(3), nullptr);
+    EXPECT_EQ(C.evictions(), 2);
+}
+
+TEST(LRU, ByteCapacity)
+{
+    auto bytes = [](const std::string &key, const std::string &val) { return key.size() + val.size(); };
+    g::lru_cache<std::string, std::string, std::hash<std::string>, decltype(bytes)> C(100, bytes);
+
+    EXPECT_TRUE(C.put("a", std::string(49, 'a')));
+    EXPECT_TRUE(C.put("b", std::string(49, 'b')));
+    EXPECT_EQ(C.weight(), 100);
+    EXPECT_TRUE(C.put("c", std::string(9, 'c')));          // evicts "a"
+    EXPECT_EQ(C.size(), 2);
+    EXPECT_EQ(C.peek("a"), nullptr);
+    EXPECT_EQ(C.weight(), 60);
+
+    EXPECT_FALSE(C.put("d", std::string(100, 'd')));       // too heavy to be cached at all
+    EXPECT_EQ(C.size(), 2);
+    EXPECT_TRUE(C.put("c", std::string(89, 'c')));         // growing an entry evicts the others
+    EXPECT_EQ(C.size(), 1);
+    EXPECT_EQ(C.weight(), 90);
+    EXPECT_FALSE(C.put("c", std::string(100, 'c')));
+    EXPECT_EQ(C.size(), 0);
+    EXPECT_EQ(C.weight(), 0);
+}
+
+TEST(Clock, SecondChance)
+{
+    g::clock_cache<int, int> C(3);
+    C.put(1, 10);
+    C.put(2, 20);
+    C.put(3, 30);
+    EXPECT_EQ(*C.get(1), 10);
+    C.put(4, 40);                                           // 1 is referenced, 2 goes
+    EXPECT_EQ(C.peek(2), nullptr);
+    EXPECT_EQ(*C.peek(1), 10);
+    C.put(5, 50);                                           // hand moved past 1 and cleared it, 3 goes
+    EXPECT_EQ(C.peek(3), nullptr);
+    C.put(6, 60);
+    EXPECT_EQ(C.peek(1), nullptr);
+    EXPECT_EQ(C.size(), 3);
+}
+
+TEST(Clock, GrowingEntryStays)
+{
+    auto bytes = [](const std::string &key, const std::string &val) { return key.size() + val.size(); };
+    g::clock_cache<std::string, std::string, std::hash<std::string>, decltype(bytes)> C(100, bytes);
+
+    EXPECT_TRUE(C.put("a", std::string(29, 'a')));
+    EXPECT_TRUE(C.put("b", std::string(29, 'b')));
+    EXPECT_TRUE(C.put("c", std::string(29, 'c')));
+    EXPECT_NE(C.get("a"), nullptr);
+    EXPECT_NE(C.get("b"), nullptr);
+    EXPECT_TRUE(C.put("a", std::string(79, 'a')));         // the hand sweeps past "a" but takes "b" and "c"
+    EXPECT_EQ(C.size(), 1);
+    EXPECT_EQ(C.weight(), 80);
+    EXPECT_EQ(*C.peek("a"), std::string(79, 'a'));
+}
+
+TEST(Clock, RandomOps)
+{
+    g::clock_cache<int, int> C(100);
+    std::unordered_map<int, int> last;                      // last value put for every key
+    for (int i = 0; i < 50000; ++i){
+        int key = rnd() % 300, val = rnd();
+        switch (rnd() % 3){
+        case 0:
+            C.put(key, val);
+            last[key] = val;
+            break;
+        case 1:
+            C.erase(key);
+            break;
+        default:
+            if (int *v = C.get(key)){
+                EXPECT_EQ(*v, last[key]);
+            }
+        }
+        ASSERT_LE(C.size(), 100);
+    }
+    size_t count = 0;
+    C.for_each([&](int key, int val) { EXPECT_EQ(val, last[key]); ++count; });
+    EXPECT_EQ(count, C.size());
+}
+
+TEST(Sharded, Threads)
+{
+    g::sharded_cache<g::lru_cache<int, long>, 8> C(800);
+    std::vector<std::thread> T;
+    for (int t = 0; t < 4; ++t)
+        T.emplace_back([&C, t]() {
+            std::mt19937 rnd(t);
+            for (int i = 0; i < 20000; ++i){
+                int key = rnd() % 2000;
+                if (rnd() % 2)
+                    C.put(key, key * 7L);
+                else if (auto val = C.get(key)){
+                    EXPECT_EQ(*val, key * 7L);
+                }
+            }
+        });
+    for (auto &t : T)
+        t.join();
+    EXPECT_LE(C.size(), 800);
+    EXPECT_GT(C.size(), 400);
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
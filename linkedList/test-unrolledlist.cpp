@@ -0,0 +1,104 @@
+#include "unrolledlist.hpp"
+#include <list>
+#include <type_traits>
+#include <vector>
+#include <random>
+#include "gtest/gtest.h"
+
+std::mt19937 rnd(179);
+
+template<size_t K>
+void RandomOpsTest()
+{
+    for (int k = 0; k < 200; ++k){
+        g::unrolled_list<int, K> U1;
+        std::list<int> S1;
+        for (size_t i = 0; i < rnd() % 2000 + 10; ++i){
+            int a = rnd();
+            switch (rnd() % 6) {
+                case 0: U1.push_front(a); S1.push_front(a); break;
+                case 1: U1.push_back(a);  S1.push_back(a);  break;
+                case 2: if (S1.size()) { EXPECT_EQ(U1.pop_back(), S1.back());   S1.pop_back();  } break;
+                case 3: if (S1.size()) { EXPECT_EQ(U1.pop_front(), S1.front()); S1.pop_front(); } break;
+                case 4: {
+                    size_t pos = rnd() % (S1.size() + 1);
+                    auto it = U1.insert(pos == S1.size() ? U1.end() : std::next(U1.begin(), pos), a);
+                    S1.insert(std::next(S1.begin(), pos), a);
+                    EXPECT_EQ(*it, a);
+                    break;
+                }
+                default: if (S1.size()) {
+                    size_t pos = rnd() % S1.size();
+                    auto it = U1.erase(std::next(U1.begin(), pos));
+                    auto s_it = S1.erase(std::next(S1.begin(), pos));
+                    if (s_it == S1.end())
+                        EXPECT_EQ(it, U1.end());
+                    else
+                        EXPECT_EQ(*it, *s_it);
+                }
+            }
+        }
+        EXPECT_EQ(U1, S1);
+        EXPECT_EQ(U1.size(), S1.size());
+
+        size_t j = 0;
+        for (int x : S1)
+            EXPECT_EQ(U1[j++], x);
+
+        auto it = U1.end();
+        for (auto s_it = S1.rbegin(); s_it != S1.rend(); ++s_it)
+            EXPECT_EQ(*--it, *s_it);
+    }
+}
+
+TEST(Unrolled, RandomOps) {
+    RandomOpsTest<2>();
+    RandomOpsTest<3>();
+    RandomOpsTest<16>();
+    RandomOpsTest<64>();
+}
+
+TEST(Unrolled, CopyAndMove) {
+    g::unrolled_list<int, 8> U1;
+    std::vector<int> V1;
+    for (int i = 0; i < 1000; ++i){
+        int a = rnd();
+        U1.push_back(a);
+        V1.push_back(a);
+    }
+    g::unrolled_list<int, 8> U2(U1), U3;
+    U3 = std::move(U1);
+    EXPECT_EQ(U2, V1);
+    EXPECT_EQ(U3, V1);
+    EXPECT_EQ(U1.size(), 0);
+    U2[10] = V1[10] + 1;
+    EXPECT_NE(U2, U3);
+}
+
+TEST(Unrolled, ConstIterators) {
+    g::unrolled_list<int, 4> U1;
+    for (int i = 0; i < 100; ++i)
+        U1.push_back(i);
+    const auto &C1 = U1;
+    static_assert(std::is_same_v<decltype(*C1.begin()), const int&>);
+    static_assert(std::is_same_v<decltype(*U1.begin()), int&>);
+
+    int expected = 0;
+    for (int x : C1)
+        EXPECT_EQ(x, expected++);
+    EXPECT_EQ(expected, 100);
+
+    g::unrolled_list<int, 4>::const_iterator it = U1.begin();
+    it = std::next(C1.begin(), 10);
+    auto next = U1.erase(it);
+    EXPECT_EQ(*next, 11);
+    next = U1.insert(C1.cend(), 100);
+    EXPECT_EQ(*next, 100);
+    EXPECT_EQ(*--C1.end(), 100);
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
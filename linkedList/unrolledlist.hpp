@@ -0,0 +1,351 @@
+#ifndef UNROLLEDLIST_HPP
+#define UNROLLEDLIST_HPP
+
+#include <iostream>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+#include "linkedlist.hpp"
+
+namespace g {
+
+//==========================================
+// Unrolled linked list
+//
+// Doubly-linked list of pooled nodes holding up to K elements each in a contiguous array.
+// A full node is split in half on insertion, a node that drops below half is refilled from
+// (or merged with) its successor, so every node but the last one stays at least half full.
+
+template<typename T, size_t K = 64>
+class unrolled_list {
+    static_assert(K >= 2, "unrolled_list needs at least two elements per node");
+
+public:
+    struct Node{
+        size_t next_;
+        size_t prev_;
+        size_t count_;
+        T vals_[K];
+    };
+
+private:
+    size_t head_;
+    size_t tail_;
+    size_t size_;
+    ObjPool<Node> pool;
+
+public:
+    //===================================
+    //  Interface functions
+
+    unrolled_list() : head_(-1), tail_(-1), size_(0) {}
+    unrolled_list( const unrolled_list &other ) = default;
+    unrolled_list( unrolled_list &&other ) : head_(other.head_), tail_(other.tail_), size_(other.size_), pool(std::move(other.pool)) { other.head_ = other.tail_ = -1; other.size_ = 0; }
+
+    unrolled_list& operator=( const unrolled_list &other ) = default;
+    unrolled_list& operator=( unrolled_list &&other ) { head_ = other.head_; tail_ = other.tail_; size_ = other.size_; pool = std::move(other.pool); other.head_ = other.tail_ = -1; other.size_ = 0; return *this; }
+
+    template<bool Const>
+    struct basic_iterator;
+    using Iterator      = basic_iterator<false>;
+    using ConstIterator = basic_iterator<true>;
+
+    void push_back( const T &val );
+    void push_front( const T &val );
+    T pop_back();
+    T pop_front();
+
+    // Inserts before pos, pos may be end(); returns iterator to the inserted element
+    Iterator insert( ConstIterator pos, const T &val );
+    // Returns iterator to the element that followed the erased one
+    Iterator erase( ConstIterator pos );
+
+    size_t size() const { return size_; }
+
+    T& front() { assert(size_); return pool.get(head_)->vals_[0]; }
+    T& back()  { assert(size_); Node *v = pool.get(tail_); return v->vals_[v->count_ - 1]; }
+
+    T& operator[]( size_t n )             { ConstIterator it = at(n); return pool.get(it.node_)->vals_[it.idx_]; }
+    const T& operator[]( size_t n ) const { ConstIterator it = at(n); return pool.get(it.node_)->vals_[it.idx_]; }
+
+    template<class Container>
+    bool operator==( const Container &other ) const;
+    template<class Container>
+    bool operator!=( const Container &other ) const { return !(*this == other); }
+
+    void dump( std::ostream &out ) const;
+
+    //===================================
+    //  Iterators
+
+    template<bool Const>
+    struct basic_iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = T;
+        using pointer           = std::conditional_t<Const, const T*, T*>;
+        using reference         = std::conditional_t<Const, const T&, T&>;
+        using list_pointer      = std::conditional_t<Const, const unrolled_list*, unrolled_list*>;
+
+        basic_iterator( size_t node = -1, size_t idx = 0, list_pointer list = nullptr ) : list_(list), node_(node), idx_(idx) {}
+        basic_iterator( const basic_iterator &other ) = default;
+        basic_iterator& operator=( const basic_iterator &other ) = default;
+
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator( const basic_iterator<false> &other ) : list_(other.list_), node_(other.node_), idx_(other.idx_) {}
+
+        bool operator==( const basic_iterator &other ) const { return node_ == other.node_ && idx_ == other.idx_; }
+        bool operator!=( const basic_iterator &other ) const { return !(*this == other); }
+
+        reference operator*()  const { assert(node_ != -1); return list_->pool.get(node_)->vals_[idx_]; }
+        pointer   operator->() const { return &**this; }
+
+        basic_iterator& operator++() {
+            Node *v = list_->pool.get(node_);
+            if (++idx_ == v->count_) {
+                node_ = v->next_;
+                idx_ = 0;
+            }
+            return *this;
+        }
+
+        basic_iterator operator++(int) { basic_iterator result(*this); ++*this; return result; }
+
+        basic_iterator& operator--() {
+            if (idx_ == 0) {
+                node_ = (node_ == -1 ? list_->tail_ : list_->pool.get(node_)->prev_);
+                idx_ = list_->pool.get(node_)->count_;
+            }
+            --idx_;
+            return *this;
+        }
+
+        basic_iterator operator--(int) { basic_iterator result(*this); --*this; return result; }
+
+    private:
+        list_pointer list_;
+        size_t node_;
+        size_t idx_;
+
+        friend class unrolled_list;
+        template<bool> friend struct basic_iterator;
+    };
+
+    using iterator       = Iterator;
+    using const_iterator = ConstIterator;
+
+    Iterator begin() { return Iterator(head_, 0, this); }
+    Iterator end()   { return Iterator(   -1, 0, this); }
+
+    ConstIterator begin() const { return ConstIterator(head_, 0, this); }
+    ConstIterator end()   const { return ConstIterator(   -1, 0, this); }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend()   const { return end(); }
+
+private:
+    size_t new_node_after( size_t pos_id );             // pos_id == -1 links to the front
+    void   free_node( size_t id );
+    size_t split( size_t id );
+    void   rebalance( size_t id );
+
+    ConstIterator at( size_t n ) const;
+};
+
+template<typename T, size_t K>
+size_t unrolled_list<T, K>::new_node_after(size_t pos_id) {
+    size_t id = pool.alloc();
+    Node *v = pool.get(id);
+    v->count_ = 0;
+    v->prev_ = pos_id;
+    if (pos_id == -1) {
+        v->next_ = head_;
+        head_ = id;
+    } else {
+        Node *p = pool.get(pos_id);
+        v->next_ = p->next_;
+        p->next_ = id;
+    }
+    if (v->next_ == -1)
+        tail_ = id;
+    else
+        pool.get(v->next_)->prev_ = id;
+    return id;
+}
+
+template<typename T, size_t K>
+void unrolled_list<T, K>::free_node(size_t id) {
+    Node *v = pool.get(id);
+    if (v->prev_ == -1)
+        head_ = v->next_;
+    else
+        pool.get(v->prev_)->next_ = v->next_;
+    if (v->next_ == -1)
+        tail_ = v->prev_;
+    else
+        pool.get(v->next_)->prev_ = v->prev_;
+    pool.free(id);
+}
+
+template<typename T, size_t K>
+size_t unrolled_list<T, K>::split(size_t id) {
+    size_t new_id = new_node_after(id);
+    Node *v = pool.get(id), *w = pool.get(new_id);
+    size_t half = v->count_ / 2;
+    std::move(v->vals_ + half, v->vals_ + v->count_, w->vals_);
+    w->count_ = v->count_ - half;
+    v->count_ = half;
+    return new_id;
+}
+
+template<typename T, size_t K>
+void unrolled_list<T, K>::rebalance(size_t id) {
+    Node *v = pool.get(id);
+    if (v->count_ >= K / 2 || v->next_ == -1)
+        return;
+
+    Node *w = pool.get(v->next_);
+    if (v->count_ + w->count_ <= K) {                       // merge the successor into this node
+        std::move(w->vals_, w->vals_ + w->count_, v->vals_ + v->count_);
+        v->count_ += w->count_;
+        free_node(v->next_);
+    } else {                                                // borrow the successor's first element
+        v->vals_[v->count_++] = std::move(w->vals_[0]);
+        std::move(w->vals_ + 1, w->vals_ + w->count_, w->vals_);
+        --w->count_;
+    }
+}
+
+template<typename T, size_t K>
+void unrolled_list<T, K>::push_back(const T &val) {
+    if (tail_ == -1 || pool.get(tail_)->count_ == K)
+        new_node_after(tail_);
+    Node *v = pool.get(tail_);
+    v->vals_[v->count_++] = val;
+    ++size_;
+}
+
+template<typename T, size_t K>
+void unrolled_list<T, K>::push_front(const T &val) {
+    insert(begin(), val);
+}
+
+template<typename T, size_t K>
+T unrolled_list<T, K>::pop_back() {
+    assert(size_);
+    T result = back();
+    erase(Iterator(tail_, pool.get(tail_)->count_ - 1, this));
+    return result;
+}
+
+template<typename T, size_t K>
+T unrolled_list<T, K>::pop_front() {
+    assert(size_);
+    T result = front();
+    erase(begin());
+    return result;
+}
+
+template<typename T, size_t K>
+typename unrolled_list<T, K>::Iterator unrolled_list<T, K>::insert(ConstIterator pos, const T &val) {
+    if (pos.node_ == -1) {
+        push_back(val);
+        return Iterator(tail_, pool.get(tail_)->count_ - 1, this);
+    }
+
+    size_t id = pos.node_, idx = pos.idx_;
+    if (pool.get(id)->count_ == K) {
+        size_t new_id = split(id);
+        size_t half = pool.get(id)->count_;
+        if (idx > half) {
+            id = new_id;
+            idx -= half;
+        }
+    }
+
+    Node *v = pool.get(id);
+    std::move_backward(v->vals_ + idx, v->vals_ + v->count_, v->vals_ + v->count_ + 1);
+    v->vals_[idx] = val;
+    ++v->count_;
+    ++size_;
+    return Iterator(id, idx, this);
+}
+
+template<typename T, size_t K>
+typename unrolled_list<T, K>::Iterator unrolled_list<T, K>::erase(ConstIterator pos) {
+    assert(pos.node_ != -1);
+    size_t id = pos.node_, idx = pos.idx_;
+    Node *v = pool.get(id);
+    std::move(v->vals_ + idx + 1, v->vals_ + v->count_, v->vals_ + idx);
+    --v->count_;
+    --size_;
+
+    if (v->count_ == 0) {
+        size_t next = v->next_;
+        free_node(id);
+        return Iterator(next, 0, this);
+    }
+
+    rebalance(id);
+    if (idx == v->count_)
+        return Iterator(v->next_, 0, this);
+    return Iterator(id, idx, this);
+}
+
+template<typename T, size_t K>
+typename unrolled_list<T, K>::ConstIterator unrolled_list<T, K>::at(size_t n) const {
+    assert(n < size_);
+    size_t id;
+    if (n < size_ / 2) {
+        id = head_;
+        Node *v;
+        while (n >= (v = pool.get(id))->count_) {
+            n -= v->count_;
+            id = v->next_;
+        }
+    } else {
+        size_t rest = size_ - n;                            // position counted from the back, >= 1
+        id = tail_;
+        Node *v;
+        while (rest > (v = pool.get(id))->count_) {
+            rest -= v->count_;
+            id = v->prev_;
+        }
+        n = v->count_ - rest;
+    }
+    return ConstIterator(id, n, this);
+}
+
+template<typename T, size_t K>
+template<class Container>
+bool unrolled_list<T, K>::operator==(const Container &other) const {
+    if (size() != other.size())
+        return false;
+
+    auto iter_2 = other.begin();
+    for (size_t id = head_; id != -1; id = pool.get(id)->next_) {
+        Node *v = pool.get(id);
+        for (size_t i = 0; i < v->count_; ++i, ++iter_2)
+            if (v->vals_[i] != *iter_2)
+                return false;
+    }
+    return true;
+}
+
+template<typename T, size_t K>
+void unrolled_list<T, K>::dump(std::ostream &out) const {
+    out << "head = " << head_ << '\n';
+    out << "tail = " << tail_ << '\n';
+    out << "size = " << size_ << '\n';
+    for (size_t id = head_; id != -1; id = pool.get(id)->next_) {
+        Node *v = pool.get(id);
+        out << "[ ";
+        for (size_t i = 0; i < v->count_; ++i)
+            out << v->vals_[i] << ' ';
+        out << "] ";
+    }
+    out << '\n';
+}
+
+} // namespace g
+#endif
@@ -109,17 +109,23 @@ public:
 
     void deallocate(void *ptr)
     {
-        ++free_count_;
-        auto slab = std::lower_bound(slabs_.begin(), slabs_.end(), (uint8_t*)ptr) - 1;
-        size_t slab_pos = slab - slabs_.begin();
-        size_t node_pos = ((uint8_t*)ptr - *slab) / objsize_;
+        uint8_t *byte_ptr = (uint8_t*)ptr;
+        size_t slab_pos = 0;
+        while (slab_pos < slabs_.size() &&
+               !(slabs_[slab_pos] <= byte_ptr && byte_ptr < slabs_[slab_pos] + slab_sizes_[slab_pos] * objsize_))
+            ++slab_pos;                     // slabs come from independent callocs, so their addresses are not ordered
 
-        if (node_pos >= slab_sizes_[slab_pos])
+        if (slab_pos == slabs_.size())
             throw std::out_of_range("attempt to free pointer outside of MemPool");
 
+        size_t node_pos = (byte_ptr - slabs_[slab_pos]) / objsize_;
+
+        ++free_count_;
         free_nodes_.push_back(PoolId(slab_pos, node_pos));
     }
 
+    size_t objsize() const { return objsize_; }
+
 private:
     std::vector<uint8_t*> slabs_;
     std::vector<size_t> slab_sizes_;
@@ -0,0 +1,66 @@
+#include "mpscqueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Usage: mpscqueue-bench [messages per run = 16000000]
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Consume>
+static double run(size_t producers, size_t n, Consume consume)
+{
+    g::mpsc_queue<uint64_t> Q(n / producers);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p)
+        threads.emplace_back([&, p]() {
+            while (!go.load(std::memory_order_acquire))
+                ;
+            for (size_t i = p; i < n; i += producers)
+                Q.push(i);
+        });
+
+    uint64_t sum = 0;
+    size_t received = 0;
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    while (received < n)
+        received += consume(Q, sum);
+    double time = seconds_since(start);
+
+    for (auto &t : threads)
+        t.join();
+    if (sum != uint64_t(n) * (n - 1) / 2)
+        std::printf("checksum mismatch\n");
+    return time;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16000000;
+
+    auto pop = [](g::mpsc_queue<uint64_t> &Q, uint64_t &sum) -> size_t {
+        if (auto x = Q.pop()) {
+            sum += *x;
+            return 1;
+        }
+        return 0;
+    };
+    auto drain = [](g::mpsc_queue<uint64_t> &Q, uint64_t &sum) -> size_t {
+        return Q.drain([&sum](uint64_t &&x) { sum += x; });
+    };
+
+    std::printf("%10s %14s %14s\n", "producers", "pop Mmsg/s", "drain Mmsg/s");
+    for (size_t producers = 1; producers <= 16; producers *= 2) {
+        double pop_time   = run(producers, n, pop);
+        double drain_time = run(producers, n, drain);
+        std::printf("%10zu %14.2f %14.2f\n", producers, n / pop_time / 1e6, n / drain_time / 1e6);
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef MPSCQUEUE_HPP
+#define MPSCQUEUE_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "../objpool/atomicobjpool.hpp"
+
+namespace g {
+
+//==========================================
+// Multi-producer single-consumer queue
+//
+// Vyukov's intrusive queue over pooled nodes: producers swing head_ with a single exchange and
+// then link the previous node, so push never loops. The consumer owns tail_, which always points
+// at a stub node whose value has already been taken. A producer preempted between the exchange and
+// the link hides everything pushed after it until it resumes; pop reports empty in that window.
+
+template<typename T>
+class mpsc_queue {
+private:
+    static constexpr uint32_t NIL = AtomicObjPool<int>::NIL;
+
+    struct Node {
+        std::atomic<uint32_t> next;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T& value() { return *std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    AtomicObjPool<Node> pool_;
+    alignas(64) std::atomic<uint32_t> head_;        // last pushed node, shared by the producers
+    alignas(64) uint32_t tail_;                     // stub node, consumer only
+
+public:
+    explicit mpsc_queue(size_t capacity = 1024) : pool_(capacity)
+    {
+        uint32_t stub = pool_.alloc();
+        new(&pool_.get(stub).next) std::atomic<uint32_t>(NIL);
+        head_.store(stub, std::memory_order_relaxed);
+        tail_ = stub;
+    }
+
+    mpsc_queue(const mpsc_queue &other) = delete;
+    mpsc_queue& operator=(const mpsc_queue &other) = delete;
+
+    ~mpsc_queue()
+    {
+        drain([](T&&) {});
+    }
+
+    // Any thread
+    template<typename ...Args>
+    void emplace(Args&&... args)
+    {
+        uint32_t id = pool_.alloc();
+        Node &v = pool_.get(id);
+        new(&v.next) std::atomic<uint32_t>(NIL);
+        new(v.storage) T(std::forward<Args>(args)...);
+
+        uint32_t prev = head_.exchange(id, std::memory_order_acq_rel);
+        pool_.get(prev).next.store(id, std::memory_order_release);
+    }
+
+    void push(const T &val) { emplace(val); }
+    void push(T &&val)      { emplace(std::move(val)); }
+
+    // Consumer only
+    std::optional<T> pop()
+    {
+        uint32_t next = pool_.get(tail_).next.load(std::memory_order_acquire);
+        if (next == NIL)
+            return std::nullopt;
+
+        T &val = pool_.get(next).value();
+        std::optional<T> result(std::move(val));
+        val.~T();
+        pool_.free(std::exchange(tail_, next));
+        return result;
+    }
+
+    // Consumer only; hands every visible element to func(T&&) and returns the nodes to the pool
+    // with a single CAS, returns the number of consumed elements
+    template<typename FunctionT>
+    size_t drain(FunctionT func)
+    {
+        uint32_t first = tail_, last = NIL;
+        size_t count = 0;
+        uint32_t next;
+        while ((next = pool_.get(tail_).next.load(std::memory_order_acquire)) != NIL) {
+            T &val = pool_.get(next).value();
+            func(std::move(val));
+            val.~T();
+            pool_.link(tail_, next);                // chains the consumed stubs for free_chain
+            last = std::exchange(tail_, next);
+            ++count;
+        }
+        if (count != 0)
+            pool_.free_chain(first, last);
+        return count;
+    }
+
+    // Consumer only; a push that has not been linked yet is not seen
+    bool empty() const
+    {
+        return pool_.get(tail_).next.load(std::memory_order_acquire) == NIL;
+    }
+};
+
+} // namespace g
+#endif
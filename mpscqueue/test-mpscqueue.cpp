@@ -0,0 +1,115 @@
+#include "mpscqueue.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+#include <random>
+#include "gtest/gtest.h"
+
+std::mt19937 rnd(179);
+
+TEST(AtomicObjPool, ReuseAndGrowth) {
+    g::AtomicObjPool<size_t> P(2);
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i < 1000; ++i) {
+        ids.push_back(P.create(i));
+        P.get(ids.back()) *= 2;
+    }
+    for (size_t i = 0; i < ids.size(); ++i)
+        EXPECT_EQ(P.get(ids[i]), 2 * i);
+
+    for (size_t i = 0; i < ids.size(); i += 2)
+        P.destroy(ids[i]);
+    for (size_t i = 0; i < ids.size(); i += 2) {
+        uint32_t id = P.alloc();
+        EXPECT_LT(id, 1022u);                       // freed slots are reused before growing
+    }
+}
+
+TEST(AtomicObjPool, Concurrent) {
+    g::AtomicObjPool<size_t> P(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t)
+        threads.emplace_back([&P, t]() {
+            std::vector<uint32_t> mine;
+            for (size_t round = 0; round < 100; ++round) {
+                for (size_t i = 0; i < 100; ++i)
+                    mine.push_back(P.create(t));
+                for (uint32_t id : mine) {
+                    EXPECT_EQ(P.get(id), t);
+                    P.destroy(id);
+                }
+                mine.clear();
+            }
+        });
+    for (auto &t : threads)
+        t.join();
+}
+
+TEST(MPSCQueue, SingleThread) {
+    g::mpsc_queue<int> Q(2);
+    EXPECT_TRUE(Q.empty());
+    EXPECT_FALSE(Q.pop().has_value());
+
+    std::vector<int> V(1000);
+    for (auto &x : V) {
+        x = rnd();
+        Q.push(x);
+    }
+    EXPECT_FALSE(Q.empty());
+    for (size_t i = 0; i < V.size() / 2; ++i)
+        EXPECT_EQ(*Q.pop(), V[i]);
+
+    std::vector<int> rest;
+    EXPECT_EQ(Q.drain([&](int &&x) { rest.push_back(x); }), V.size() - V.size() / 2);
+    EXPECT_EQ(rest, std::vector<int>(V.begin() + V.size() / 2, V.end()));
+    EXPECT_TRUE(Q.empty());
+    EXPECT_EQ(Q.drain([](int &&) {}), 0);
+}
+
+TEST(MPSCQueue, NonTrivial) {
+    g::mpsc_queue<std::string> Q;
+    for (size_t i = 0; i < 100; ++i)
+        Q.emplace(50, char('a' + i % 26));
+    EXPECT_EQ(*Q.pop(), std::string(50, 'a'));
+    Q.drain([](std::string &&s) { EXPECT_EQ(s.size(), 50); });
+
+    for (size_t i = 0; i < 100; ++i)
+        Q.push(std::string(i, 'x'));                // left in the queue for the destructor
+}
+
+TEST(MPSCQueue, Producers) {
+    const size_t producers = 8, n = 50000;
+    g::mpsc_queue<std::pair<size_t, size_t>> Q(16);
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p)
+        threads.emplace_back([&Q, p]() {
+            for (size_t i = 0; i < n; ++i)
+                Q.push({p, i});
+        });
+
+    std::vector<size_t> expected(producers, 0);
+    size_t received = 0;
+    auto check = [&](std::pair<size_t, size_t> &&msg) {
+        EXPECT_EQ(msg.second, expected[msg.first]++);   // per-producer FIFO
+        ++received;
+    };
+    while (received < producers * n) {
+        if (rnd() % 2)
+            Q.drain(check);
+        else if (auto msg = Q.pop())
+            check(std::move(*msg));
+    }
+
+    for (auto &t : threads)
+        t.join();
+    EXPECT_TRUE(Q.empty());
+    for (size_t p = 0; p < producers; ++p)
+        EXPECT_EQ(expected[p], n);
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace g {
+
+// Thread-safe index-based object pool.
+//
+// Slab k holds capacity << k slots and is never moved or freed before the pool dies, so ids and
+// references stay valid while other threads allocate. The free list is a Treiber stack whose
+// head carries an ABA tag next to the 32-bit slot id; only growing takes a lock.
+// Objects are constructed and destroyed by the caller, the pool itself only hands out storage.
+template<typename Data>
+class AtomicObjPool
+{
+public:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+private:
+    static constexpr size_t MAX_SLABS = 32;
+
+    struct Node {
+        std::atomic<uint32_t> next;
+        alignas(Data) unsigned char storage[sizeof(Data)];
+    };
+
+public:
+    explicit AtomicObjPool(size_t capacity = 64) :
+        shift_(std::bit_width(std::bit_ceil(capacity < 2 ? 2 : capacity)) - 1),
+        slab_count_(0),
+        free_head_(pack(0, NIL))
+    {
+        for (auto &slab : slabs_)
+            slab.store(nullptr, std::memory_order_relaxed);
+        grow();
+    }
+
+    AtomicObjPool(const AtomicObjPool &other) = delete;
+    AtomicObjPool& operator=(const AtomicObjPool &other) = delete;
+
+    ~AtomicObjPool()
+    {
+        for (auto &slab : slabs_)
+            std::free(slab.load(std::memory_order_relaxed));
+    }
+
+    uint32_t alloc()
+    {
+        while (true) {
+            uint64_t head = free_head_.load(std::memory_order_acquire);
+            uint32_t id = index_of(head);
+            if (id == NIL) {
+                grow();
+                continue;
+            }
+            uint32_t next = node(id).next.load(std::memory_order_relaxed);
+            if (free_head_.compare_exchange_weak(head, pack(tag_of(head) + 1, next),
+                                                 std::memory_order_acq_rel, std::memory_order_acquire))
+                return id;
+        }
+    }
+
+    template<typename ...Args>
+    uint32_t create(Args&&... args)
+    {
+        uint32_t id = alloc();
+        new(node(id).storage) Data(std::forward<Args>(args)...);
+        return id;
+    }
+
+    Data& get(uint32_t id) const
+    {
+        return *std::launder(reinterpret_cast<Data*>(node(id).storage));
+    }
+
+    void free(uint32_t id)
+    {
+        free_chain(id, id);
+    }
+
+    // Returns first..last, already linked through link(), to the pool with a single CAS
+    void free_chain(uint32_t first, uint32_t last)
+    {
+        uint64_t head = free_head_.load(std::memory_order_relaxed);
+        do {
+            node(last).next.store(index_of(head), std::memory_order_relaxed);
+        } while (!free_head_.compare_exchange_weak(head, pack(tag_of(head) + 1, first),
+                                                   std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void link(uint32_t id, uint32_t next) { node(id).next.store(next, std::memory_order_relaxed); }
+
+    void destroy(uint32_t id)
+    {
+        get(id).~Data();
+        free(id);
+    }
+
+private:
+    Node& node(uint32_t id) const
+    {
+        size_t k = std::bit_width((id >> shift_) + 1) - 1;
+        size_t offset = id - (((size_t(1) << k) - 1) << shift_);
+        Node *slab = slabs_[k].load(std::memory_order_acquire);
+        assert(slab != nullptr);
+        return slab[offset];
+    }
+
+    static uint64_t pack(uint32_t tag, uint32_t id) { return (uint64_t(tag) << 32) | id; }
+    static uint32_t tag_of(uint64_t head)          { return uint32_t(head >> 32); }
+    static uint32_t index_of(uint64_t head)        { return uint32_t(head); }
+
+    void grow()
+    {
+        std::lock_guard<std::mutex> lock(grow_mutex_);
+        if (index_of(free_head_.load(std::memory_order_acquire)) != NIL)
+            return;                                 // someone else refilled the free list
+
+        size_t k = slab_count_;
+        if (k == MAX_SLABS || (((size_t(1) << (k + 1)) - 1) << shift_) >= NIL)
+            throw std::bad_alloc();
+
+        size_t size  = size_t(1) << (shift_ + k);
+        size_t first = ((size_t(1) << k) - 1) << shift_;
+        Node *slab = static_cast<Node*>(std::calloc(size, sizeof(Node)));
+        if (slab == nullptr)
+            throw std::bad_alloc();
+
+        for (size_t i = 0; i + 1 < size; ++i)
+            new(&slab[i].next) std::atomic<uint32_t>(uint32_t(first + i + 1));
+        new(&slab[size - 1].next) std::atomic<uint32_t>(NIL);
+
+        slabs_[k].store(slab, std::memory_order_release);
+        slab_count_ = k + 1;
+        free_chain(uint32_t(first), uint32_t(first + size - 1));
+    }
+
+    std::atomic<Node*> slabs_[MAX_SLABS];
+    size_t shift_;                                  // slab 0 holds 1 << shift_ slots
+    size_t slab_count_;
+    std::mutex grow_mutex_;
+    alignas(64) std::atomic<uint64_t> free_head_;
+};
+
+} /* namespace g */
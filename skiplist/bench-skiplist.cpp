@@ -0,0 +1,111 @@
+#include "skiplist.hpp"
+#include "../treap/treap.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Usage: skiplist-bench [keys = 1000000] [max threads = 16]
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct result {
+    double insert, find, erase;
+};
+
+template<typename Insert, typename Find, typename Erase>
+static result run(const std::vector<int> &keys, Insert insert, Find find, Erase erase)
+{
+    result r;
+    auto start = std::chrono::steady_clock::now();
+    for (int k : keys)
+        insert(k);
+    r.insert = seconds_since(start);
+
+    long long sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int k : keys)
+        sum += find(k);
+    r.find = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int k : keys)
+        erase(k);
+    r.erase = seconds_since(start);
+
+    if (sum == 42)
+        std::printf(" ");
+    return r;
+}
+
+static void print(const char *name, size_t n, result r)
+{
+    std::printf("%-16s %10.1f %10.1f %10.1f\n", name, n / r.insert / 1e6, n / r.find / 1e6, n / r.erase / 1e6);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n       = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+
+    std::mt19937 rnd(179);
+    std::vector<int> keys(n);
+    for (auto &k : keys)
+        k = rnd();
+
+    std::printf("single thread, Mops/s\n%-16s %10s %10s %10s\n", "", "insert", "find", "erase");
+    {
+        g::skiplist<int, int> S(n);
+        print("g::skiplist", n, run(keys, [&](int k) { S.insert(k, k); },
+                                          [&](int k) { return *S.find(k); },
+                                          [&](int k) { S.erase(k); }));
+    }
+    {
+        g::treap<int, int> T;
+        print("g::treap", n, run(keys, [&](int k) { T.insert(k, k); },
+                                       [&](int k) { return *T.find(k); },
+                                       [&](int k) { T.erase(k); }));
+    }
+    {
+        std::map<int, int> M;
+        print("std::map", n, run(keys, [&](int k) { M[k] = k; },
+                                       [&](int k) { return M.find(k)->second; },
+                                       [&](int k) { M.erase(k); }));
+    }
+
+    // Every thread inserts, looks up and erases its own slice of the keys
+    std::printf("\nconcurrent writers, total Mops/s\n%-8s %24s %24s\n", "threads", "g::concurrent_skiplist", "std::map + mutex");
+    for (size_t t = 1; t <= threads; t *= 2) {
+        g::concurrent_skiplist<int, int> S(n);
+        std::map<int, int> M;
+        std::mutex mutex;
+
+        auto parallel = [&](auto body) {
+            std::vector<std::thread> workers;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < t; ++i)
+                workers.emplace_back([&, i]() {
+                    for (size_t j = i; j < n; j += t)
+                        body(keys[j]);
+                });
+            for (auto &w : workers)
+                w.join();
+            return seconds_since(start);
+        };
+
+        double skip = parallel([&](int k) { S.insert(k, k); })
+                    + parallel([&](int k) { S.contains(k); })
+                    + parallel([&](int k) { S.erase(k); });
+        double map  = parallel([&](int k) { std::lock_guard<std::mutex> lock(mutex); M[k] = k; })
+                    + parallel([&](int k) { std::lock_guard<std::mutex> lock(mutex); M.count(k); })
+                    + parallel([&](int k) { std::lock_guard<std::mutex> lock(mutex); M.erase(k); });
+        std::printf("%-8zu %24.1f %24.1f\n", t, 3 * n / skip / 1e6, 3 * n / map / 1e6);
+    }
+}
@@ -0,0 +1,513 @@
+#ifndef SKIPLIST_HPP
+#define SKIPLIST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "../objpool/atomicobjpool.hpp"
+
+namespace g {
+
+namespace detail {
+
+inline uint64_t skiplist_xorshift(uint64_t &x)
+{
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+
+// Geometric tower height with p = 1/4, in [1, max_level]
+inline uint32_t skiplist_height(uint64_t r, uint32_t max_level)
+{
+    uint32_t h = 1 + std::countr_zero(r | (uint64_t(1) << 63)) / 2;
+    return h < max_level ? h : max_level;
+}
+
+} // namespace detail
+
+//==========================================
+// Skip list
+//
+// Ordered map over index-based pooled nodes. Every node carries a full MAX_LEVEL tower of 32-bit
+// links, so a node is a single pool slot; with p = 1/4 the towers cover every id the pool can hand
+// out. Node 0 of the pool is the head sentinel.
+
+template<typename Key, typename Data>
+class skiplist
+{
+public:
+    static constexpr uint32_t MAX_LEVEL = 16;
+
+private:
+    static constexpr uint32_t NIL = AtomicObjPool<int>::NIL;
+
+    struct Node
+    {
+        Key x;
+        Data val;
+        uint32_t height;
+        uint32_t next[MAX_LEVEL];
+    };
+
+    std::unique_ptr<AtomicObjPool<Node>> pool;
+    uint32_t head_id;
+    uint32_t level;                                 // highest level in use
+    size_t size_;
+    uint64_t seed;
+
+public:
+    struct Iterator
+    {
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::pair<const Key, Data>;
+
+        Iterator( uint32_t id = NIL, const skiplist *this_ = nullptr ) : id(id), this_(this_) {}
+
+        bool operator==( const Iterator &other ) const { return id == other.id; }
+        bool operator!=( const Iterator &other ) const { return id != other.id; }
+
+        std::pair<const Key&, Data&> operator*() const { Node &v = this_->node(id); return {v.x, v.val}; }
+
+        Iterator& operator++()   { assert(id != NIL); id = this_->node(id).next[0]; return *this; }
+        Iterator  operator++(int) { Iterator result(*this); ++*this; return result; }
+
+    private:
+        uint32_t id;
+        const skiplist *this_;
+    };
+
+    Iterator begin() const { return Iterator(node(head_id).next[0], this); }
+    Iterator end()   const { return Iterator(NIL, this); }
+
+    //======================================
+    // Interface functions
+
+    explicit skiplist( size_t capacity = 64 );
+    skiplist( const skiplist &other ) = delete;
+    skiplist( skiplist &&other ) : pool(std::move(other.pool)), head_id(other.head_id), level(other.level), size_(other.size_), seed(other.seed) { other.size_ = 0; }
+    ~skiplist();
+
+    skiplist& operator=( const skiplist &other ) = delete;
+
+    size_t size()  const { return size_; }
+    bool   empty() const { return size_ == 0; }
+
+    // Overwrites the value of an existing key
+    void  insert( Key x, Data val ) { *insert(x) = val; }
+    // Returns the value of x, default-constructing it if x is new
+    Data* insert( Key x );
+    bool  erase ( Key x );
+
+    Data* find( Key x ) const;
+    Iterator lower_bound( Key x ) const;
+
+    void dump( std::ostream &out ) const;
+
+private:
+    Node& node( uint32_t id ) const { return pool->get(id); }
+
+    // Fills update[] with the last node before x on every level, returns the first node >= x
+    uint32_t search( const Key &x, uint32_t *update ) const;
+};
+
+template<typename Key, typename Data>
+skiplist<Key, Data>::skiplist(size_t capacity) :
+    pool(new AtomicObjPool<Node>(capacity + 1)),
+    level(1),
+    size_(0),
+    seed(0x9E3779B97F4A7C15ull)
+{
+    head_id = pool->create();
+    Node &h = node(head_id);
+    h.height = MAX_LEVEL;
+    std::fill(h.next, h.next + MAX_LEVEL, NIL);
+}
+
+template<typename Key, typename Data>
+skiplist<Key, Data>::~skiplist()
+{
+    if (!pool)
+        return;
+    uint32_t id = head_id;
+    while (id != NIL) {
+        uint32_t next = node(id).next[0];
+        pool->destroy(id);
+        id = next;
+    }
+}
+
+template<typename Key, typename Data>
+uint32_t skiplist<Key, Data>::search(const Key &x, uint32_t *update) const
+{
+    uint32_t id = head_id;
+    for (uint32_t l = level; l-- > 0; ) {
+        uint32_t next;
+        while ((next = node(id).next[l]) != NIL && node(next).x < x)
+            id = next;
+        if (update)
+            update[l] = id;
+    }
+    return node(id).next[0];
+}
+
+template<typename Key, typename Data>
+Data* skiplist<Key, Data>::insert(Key x)
+{
+    uint32_t update[MAX_LEVEL];
+    uint32_t id = search(x, update);
+    if (id != NIL && !(x < node(id).x))
+        return &node(id).val;
+
+    uint32_t height = detail::skiplist_height(detail::skiplist_xorshift(seed), MAX_LEVEL);
+    for (; level < height; ++level)
+        update[level] = head_id;
+
+    id = pool->create();
+    Node &v = node(id);
+    v.x = x;
+    v.height = height;
+    for (uint32_t l = 0; l < height; ++l) {
+        v.next[l] = node(update[l]).next[l];
+        node(update[l]).next[l] = id;
+    }
+    ++size_;
+    return &v.val;
+}
+
+template<typename Key, typename Data>
+bool skiplist<Key, Data>::erase(Key x)
+{
+    uint32_t update[MAX_LEVEL];
+    uint32_t id = search(x, update);
+    if (id == NIL || x < node(id).x)
+        return false;
+
+    Node &v = node(id);
+    for (uint32_t l = 0; l < v.height; ++l)
+        node(update[l]).next[l] = v.next[l];
+    while (level > 1 && node(head_id).next[level - 1] == NIL)
+        --level;
+    pool->destroy(id);
+    --size_;
+    return true;
+}
+
+template<typename Key, typename Data>
+Data* skiplist<Key, Data>::find(Key x) const
+{
+    uint32_t id = search(x, nullptr);
+    if (id == NIL || x < node(id).x)
+        return nullptr;
+    return &node(id).val;
+}
+
+template<typename Key, typename Data>
+typename skiplist<Key, Data>::Iterator skiplist<Key, Data>::lower_bound(Key x) const
+{
+    return Iterator(search(x, nullptr), this);
+}
+
+template<typename Key, typename Data>
+void skiplist<Key, Data>::dump(std::ostream &out) const
+{
+    for (uint32_t l = level; l-- > 0; ) {
+        out << "L" << l << ": ";
+        for (uint32_t id = node(head_id).next[l]; id != NIL; id = node(id).next[l])
+            out << node(id).x << ' ';
+        out << '\n';
+    }
+}
+
+//==========================================
+// Concurrent skip list
+//
+// Lock-free set of towers after Herlihy and Shavit: a link carries a deletion mark next to the
+// node id, erase marks the tower top-down and the mark on level 0 is the linearization point,
+// searches snip marked nodes as they pass. contains() never writes.
+//
+// Nodes live in a thread-safe pool, but an erased node may still be traversed by a concurrent
+// search, so it is only retired; reclaim() hands retired nodes back to the pool and must run
+// while no other operation is in progress. Values are immutable once inserted.
+
+template<typename Key, typename Data>
+class concurrent_skiplist
+{
+public:
+    static constexpr uint32_t MAX_LEVEL = 16;
+
+private:
+    static constexpr uint32_t NIL = AtomicObjPool<int>::NIL;
+
+    struct Node
+    {
+        Key x;
+        Data val;
+        uint32_t height;
+        uint32_t retired_next;
+        std::atomic<uint64_t> next[MAX_LEVEL];
+    };
+
+    static uint64_t link  ( uint32_t id, bool mark = false ) { return (uint64_t(mark) << 32) | id; }
+    static uint32_t ref   ( uint64_t link )                  { return uint32_t(link); }
+    static bool     marked( uint64_t link )                  { return link >> 32; }
+
+    AtomicObjPool<Node> pool;
+    uint32_t head_id;
+    std::atomic<size_t> size_;
+    std::atomic<uint32_t> retired;
+
+public:
+    explicit concurrent_skiplist( size_t capacity = 64 );
+    concurrent_skiplist( const concurrent_skiplist &other ) = delete;
+    concurrent_skiplist& operator=( const concurrent_skiplist &other ) = delete;
+    ~concurrent_skiplist();
+
+    // Exact once concurrent operations have finished
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    // False if x is already present, the stored value is kept
+    bool insert( const Key &x, const Data &val );
+    bool erase ( const Key &x );
+
+    bool contains( const Key &x ) const;
+    std::optional<Data> find( const Key &x ) const;
+
+    // Calls func(key, value) for every present element in order; weakly consistent under writers
+    template<typename FunctionT>
+    void for_each( FunctionT func ) const;
+
+    // WARNING: no other operation may run concurrently
+    size_t reclaim();
+
+private:
+    Node& node( uint32_t id ) const { return pool.get(id); }
+
+    bool     search( const Key &x, uint32_t *preds, uint32_t *succs );
+    uint32_t random_height();
+};
+
+template<typename Key, typename Data>
+concurrent_skiplist<Key, Data>::concurrent_skiplist(size_t capacity) : pool(capacity + 1), size_(0), retired(NIL)
+{
+    head_id = pool.alloc();
+    Node *h = new(&node(head_id)) Node();
+    h->height = MAX_LEVEL;
+    for (auto &next : h->next)
+        next.store(link(NIL), std::memory_order_relaxed);
+}
+
+template<typename Key, typename Data>
+concurrent_skiplist<Key, Data>::~concurrent_skiplist()
+{
+    reclaim();
+    uint32_t id = head_id;
+    while (id != NIL) {
+        uint32_t next = ref(node(id).next[0].load(std::memory_order_relaxed));
+        pool.destroy(id);
+        id = next;
+    }
+}
+
+template<typename Key, typename Data>
+uint32_t concurrent_skiplist<Key, Data>::random_height()
+{
+    thread_local uint64_t seed = 0x9E3779B97F4A7C15ull ^ uint64_t(reinterpret_cast<uintptr_t>(&seed));
+    return detail::skiplist_height(detail::skiplist_xorshift(seed), MAX_LEVEL);
+}
+
+template<typename Key, typename Data>
+bool concurrent_skiplist<Key, Data>::search(const Key &x, uint32_t *preds, uint32_t *succs)
+{
+retry:
+    uint32_t pred = head_id, curr = NIL;
+    for (uint32_t l = MAX_LEVEL; l-- > 0; ) {
+        curr = ref(node(pred).next[l].load(std::memory_order_acquire));
+        while (curr != NIL) {
+            uint64_t succ = node(curr).next[l].load(std::memory_order_acquire);
+            while (marked(succ)) {                  // snip curr out of this level
+                uint64_t expected = link(curr);
+                if (!node(pred).next[l].compare_exchange_strong(expected, link(ref(succ)), std::memory_order_acq_rel))
+                    goto retry;
+                curr = ref(succ);
+                if (curr == NIL)
+                    break;
+                succ = node(curr).next[l].load(std::memory_order_acquire);
+            }
+            if (curr == NIL || !(node(curr).x < x))
+                break;
+            pred = curr;
+            curr = ref(succ);
+        }
+        preds[l] = pred;
+        succs[l] = curr;
+    }
+    return curr != NIL && !(x < node(curr).x);
+}
+
+template<typename Key, typename Data>
+bool concurrent_skiplist<Key, Data>::insert(const Key &x, const Data &val)
+{
+    uint32_t preds[MAX_LEVEL], succs[MAX_LEVEL];
+    uint32_t height = random_height();
+    uint32_t id = NIL;
+
+    while (true) {
+        if (search(x, preds, succs)) {
+            if (id != NIL)
+                pool.destroy(id);                   // never published
+            return false;
+        }
+        if (id == NIL) {
+            id = pool.alloc();
+            new(&node(id)) Node{x, val, height, NIL, {}};
+        }
+        Node &v = node(id);
+        for (uint32_t l = 0; l < height; ++l)
+            v.next[l].store(link(succs[l]), std::memory_order_relaxed);
+
+        uint64_t expected = link(succs[0]);
+        if (node(preds[0]).next[0].compare_exchange_strong(expected, link(id), std::memory_order_acq_rel))
+            break;
+    }
+    size_.fetch_add(1, std::memory_order_relaxed);
+
+    Node &v = node(id);
+    for (uint32_t l = 1; l < height; ++l) {
+        while (true) {
+            uint64_t own = v.next[l].load(std::memory_order_acquire);
+            if (marked(own))
+                return true;                        // erased meanwhile, stop building the tower
+            if (ref(own) != succs[l] && !v.next[l].compare_exchange_strong(own, link(succs[l]), std::memory_order_acq_rel))
+                continue;
+            uint64_t expected = link(succs[l]);
+            if (node(preds[l]).next[l].compare_exchange_strong(expected, link(id), std::memory_order_acq_rel))
+                break;
+            search(x, preds, succs);
+            if (succs[0] != id)
+                return true;                        // our node is already gone from level 0
+        }
+    }
+    return true;
+}
+
+template<typename Key, typename Data>
+bool concurrent_skiplist<Key, Data>::erase(const Key &x)
+{
+    uint32_t preds[MAX_LEVEL], succs[MAX_LEVEL];
+    if (!search(x, preds, succs))
+        return false;
+
+    uint32_t id = succs[0];
+    Node &v = node(id);
+    for (uint32_t l = v.height; l-- > 1; ) {
+        uint64_t succ = v.next[l].load(std::memory_order_acquire);
+        while (!marked(succ))
+            v.next[l].compare_exchange_weak(succ, link(ref(succ), true), std::memory_order_acq_rel);
+    }
+
+    uint64_t succ = v.next[0].load(std::memory_order_acquire);
+    while (true) {
+        if (marked(succ))
+            return false;                           // another eraser won
+        if (v.next[0].compare_exchange_weak(succ, link(ref(succ), true), std::memory_order_acq_rel))
+            break;
+    }
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    search(x, preds, succs);                        // unlink it physically
+
+    uint32_t head = retired.load(std::memory_order_relaxed);
+    do {
+        v.retired_next = head;
+    } while (!retired.compare_exchange_weak(head, id, std::memory_order_release, std::memory_order_relaxed));
+    return true;
+}
+
+template<typename Key, typename Data>
+bool concurrent_skiplist<Key, Data>::contains(const Key &x) const
+{
+    return find(x).has_value();
+}
+
+template<typename Key, typename Data>
+std::optional<Data> concurrent_skiplist<Key, Data>::find(const Key &x) const
+{
+    uint32_t pred = head_id, curr = NIL;
+    uint64_t succ = 0;
+    for (uint32_t l = MAX_LEVEL; l-- > 0; ) {
+        curr = ref(node(pred).next[l].load(std::memory_order_acquire));
+        while (curr != NIL) {
+            succ = node(curr).next[l].load(std::memory_order_acquire);
+            while (marked(succ)) {                  // step over without snipping
+                curr = ref(succ);
+                if (curr == NIL)
+                    break;
+                succ = node(curr).next[l].load(std::memory_order_acquire);
+            }
+            if (curr == NIL || !(node(curr).x < x))
+                break;
+            pred = curr;
+            curr = ref(succ);
+        }
+    }
+    if (curr != NIL && !(x < node(curr).x))
+        return node(curr).val;
+    return std::nullopt;
+}
+
+template<typename Key, typename Data>
+template<typename FunctionT>
+void concurrent_skiplist<Key, Data>::for_each(FunctionT func) const
+{
+    uint32_t id = ref(node(head_id).next[0].load(std::memory_order_acquire));
+    while (id != NIL) {
+        uint64_t succ = node(id).next[0].load(std::memory_order_acquire);
+        if (!marked(succ))
+            func(static_cast<const Key&>(node(id).x), static_cast<const Data&>(node(id).val));
+        id = ref(succ);
+    }
+}
+
+template<typename Key, typename Data>
+size_t concurrent_skiplist<Key, Data>::reclaim()
+{
+    // A tower interrupted by an erase may have left a marked node linked on an upper level
+    for (uint32_t l = 0; l < MAX_LEVEL; ++l) {
+        uint32_t pred = head_id;
+        uint32_t curr = ref(node(pred).next[l].load(std::memory_order_relaxed));
+        while (curr != NIL) {
+            uint64_t succ = node(curr).next[l].load(std::memory_order_relaxed);
+            if (marked(succ)) {
+                node(pred).next[l].store(link(ref(succ)), std::memory_order_relaxed);
+            } else {
+                pred = curr;
+            }
+            curr = ref(succ);
+        }
+    }
+
+    size_t count = 0;
+    uint32_t id = retired.exchange(NIL, std::memory_order_acquire);
+    while (id != NIL) {
+        uint32_t next = node(id).retired_next;
+        pool.destroy(id);
+        id = next;
+        ++count;
+    }
+    return count;
+}
+
+} // namespace g
+#endif
@@ -0,0 +1,168 @@
+#include "skiplist.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+std::mt19937 rnd(179);
+
+TEST(Basics, InsertEraseFind)
+{
+    for (int p = 0; p < 5; ++p){
+        g::skiplist<int, int> S(2);
+        std::map<int, int> M;
+        for (int i = 0; i < 5000; ++i){
+            int a = rnd() % 2000, b = rnd();
+            switch (rnd() % 3){
+            case 0:
+                S.insert(a, b);
+                M[a] = b;
+                break;
+            case 1:
+                EXPECT_EQ(S.erase(a), M.erase(a) == 1);
+                break;
+            default:
+                int *q = S.find(a);
+                EXPECT_EQ(q != nullptr, M.count(a) == 1);
+                if (q){
+                    EXPECT_EQ(*q, M[a]);
+                }
+            }
+            EXPECT_EQ(S.size(), M.size());
+        }
+
+        auto iter = M.begin();
+        for (auto [x, val] : S){
+            EXPECT_EQ(x, iter->first);
+            EXPECT_EQ(val, iter->second);
+            ++iter;
+        }
+        EXPECT_EQ(iter, M.end());
+    }
+}
+
+TEST(Basics, LowerBoundAndDefaultInsert)
+{
+    g::skiplist<int, std::string> S;
+    for (int i = 0; i < 100; ++i)
+        *S.insert(i * 10) = std::to_string(i);
+    EXPECT_EQ(*S.insert(50), "5");
+    EXPECT_EQ(S.size(), 100);
+
+    EXPECT_EQ((*S.lower_bound(55)).first, 60);
+    EXPECT_EQ((*S.lower_bound(60)).second, "6");
+    EXPECT_EQ(S.lower_bound(991), S.end());
+    EXPECT_EQ(S.lower_bound(-5), S.begin());
+
+    g::skiplist<int, std::string> S2(std::move(S));
+    EXPECT_EQ(S2.size(), 100);
+    EXPECT_EQ(*S2.find(990), "99");
+}
+
+TEST(Concurrent, SingleThread)
+{
+    g::concurrent_skiplist<int, int> S(2);
+    std::map<int, int> M;
+    for (int i = 0; i < 5000; ++i){
+        int a = rnd() % 1000, b = rnd();
+        switch (rnd() % 3){
+        case 0:
+            EXPECT_EQ(S.insert(a, b), M.emplace(a, b).second);
+            break;
+        case 1:
+            EXPECT_EQ(S.erase(a), M.erase(a) == 1);
+            break;
+        default:
+            auto q = S.find(a);
+            EXPECT_EQ(q.has_value(), M.count(a) == 1);
+            if (q){
+                EXPECT_EQ(*q, M[a]);
+            }
+        }
+        if (i % 1000 == 0)
+            S.reclaim();
+    }
+    EXPECT_EQ(S.size(), M.size());
+
+    auto iter = M.begin();
+    S.for_each([&](int x, int val) {
+        EXPECT_EQ(x, iter->first);
+        EXPECT_EQ(val, iter->second);
+        ++iter;
+    });
+    EXPECT_EQ(iter, M.end());
+}
+
+TEST(Concurrent, Writers)
+{
+    const int threads = 8, n = 20000;
+    g::concurrent_skiplist<int, std::string> S;
+
+    // Every thread inserts its own keys and a shared range, then erases its odd keys
+    std::vector<std::thread> T;
+    std::atomic<int> shared_wins(0);
+    for (int t = 0; t < threads; ++t)
+        T.emplace_back([&, t]() {
+            for (int i = 0; i < n; ++i){
+                EXPECT_TRUE(S.insert(t * n + i, std::to_string(t)));
+                if (S.insert(-1 - i % 1000, "shared"))
+                    ++shared_wins;
+            }
+            for (int i = 1; i < n; i += 2)
+                EXPECT_TRUE(S.erase(t * n + i));
+            for (int i = 0; i < n; i += 2)
+                EXPECT_TRUE(S.contains(t * n + i));
+        });
+    for (auto &t : T)
+        t.join();
+
+    EXPECT_EQ(shared_wins, 1000);
+    EXPECT_EQ(S.size(), 1000 + threads * n / 2);
+    EXPECT_EQ(S.reclaim(), threads * n / 2);
+
+    int prev = -1000000, count = 0;
+    S.for_each([&](int x, const std::string &val) {
+        EXPECT_LT(prev, x);
+        if (x >= 0){
+            EXPECT_EQ(x % 2, 0);
+            EXPECT_EQ(val, std::to_string(x / n));
+        }
+        prev = x;
+        ++count;
+    });
+    EXPECT_EQ(count, S.size());
+}
+
+TEST(Concurrent, ContendedErase)
+{
+    g::concurrent_skiplist<int, int> S;
+    for (int i = 0; i < 10000; ++i)
+        S.insert(i, i);
+
+    std::atomic<int> erased(0);
+    std::vector<std::thread> T;
+    for (int t = 0; t < 4; ++t)
+        T.emplace_back([&]() {
+            for (int i = 0; i < 10000; ++i){
+                if (S.erase(i))
+                    ++erased;
+                S.insert(i + 10000, i);
+            }
+        });
+    for (auto &t : T)
+        t.join();
+
+    EXPECT_EQ(erased, 10000);
+    EXPECT_EQ(S.size(), 10000);
+    EXPECT_FALSE(S.contains(9999));
+    EXPECT_EQ(*S.find(19999), 9999);
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
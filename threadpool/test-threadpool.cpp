@@ -0,0 +1,145 @@
+#include "threadpool.hpp"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <random>
+#include <numeric>
+#include "gtest/gtest.h"
+
+std::mt19937 rnd(179);
+
+TEST(WorkStealingDeque, OwnerOnly) {
+    g::ws_deque<int> D(2);
+    std::vector<int> V(1000);
+    for (size_t i = 0; i < V.size(); ++i){
+        V[i] = rnd();
+        D.push(&V[i]);
+    }
+    for (size_t i = V.size(); i > 0; --i)
+        EXPECT_EQ(D.pop(), &V[i - 1]);
+    EXPECT_EQ(D.pop(), nullptr);
+    EXPECT_TRUE(D.empty());
+}
+
+TEST(WorkStealingDeque, Thieves) {
+    const size_t n = 200000;
+    g::ws_deque<size_t> D(4);
+    std::vector<size_t> V(n);
+    std::vector<std::atomic<int>> taken(n);
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t)
+        thieves.emplace_back([&]() {
+            while (!done.load() || !D.empty())
+                if (size_t *p = D.steal())
+                    ++taken[*p];
+        });
+
+    for (size_t i = 0; i < n; ++i){
+        V[i] = i;
+        D.push(&V[i]);
+        if (i % 3 == 0)
+            if (size_t *p = D.pop())
+                ++taken[*p];
+    }
+    while (size_t *p = D.pop())
+        ++taken[*p];
+    done.store(true);
+    for (auto &t : thieves)
+        t.join();
+
+    for (size_t i = 0; i < n; ++i)
+        EXPECT_EQ(taken[i].load(), 1);
+}
+
+TEST(ThreadPool, Submit) {
+    g::thread_pool pool(4);
+    std::vector<std::future<int>> F;
+    for (int i = 0; i < 1000; ++i)
+        F.push_back(pool.submit([i]() { return i * i; }));
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(F[i].get(), i * i);
+
+    auto fail = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+    EXPECT_THROW(fail.get(), std::runtime_error);
+}
+
+TEST(ThreadPool, SubmitFromManyThreads) {
+    std::atomic<size_t> counter(0);
+    {
+        g::thread_pool pool(3);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t)
+            producers.emplace_back([&]() {
+                for (int i = 0; i < 1000; ++i)
+                    pool.submit([&]() { ++counter; });
+            });
+        for (auto &t : producers)
+            t.join();
+    }
+    EXPECT_EQ(counter.load(), 4000);
+}
+
+TEST(ThreadPool, ParallelFor) {
+    g::thread_pool pool(4);
+    std::vector<long long> V(100000);
+    pool.parallel_for(0, V.size(), [&](size_t i) { V[i] = i * 3; });
+    for (size_t i = 0; i < V.size(); ++i)
+        EXPECT_EQ(V[i], i * 3);
+
+    std::atomic<long long> sum(0);
+    pool.parallel_for(0, 1000, [&](size_t i) { sum += i; }, 7);
+    EXPECT_EQ(sum.load(), 999 * 1000 / 2);
+}
+
+static long long fib(g::thread_pool &pool, int n)
+{
+    if (n < 12)
+        return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+    long long a = 0, b = 0;
+    pool.parallel_invoke([&]() { a = fib(pool, n - 1); },
+                         [&]() { b = fib(pool, n - 2); });
+    return a + b;
+}
+
+TEST(ThreadPool, NestedParallelInvoke) {
+    g::thread_pool pool(4);
+    auto res = pool.submit([&]() { return fib(pool, 25); });
+    EXPECT_EQ(res.get(), 75025);
+    EXPECT_EQ(fib(pool, 22), 17711);
+}
+
+TEST(ThreadPool, ParallelInvokeThrows) {
+    // Whichever thread runs b, the exception from a must not leave before b is done
+    g::thread_pool pool(2);
+    std::atomic<bool> b_done(false);
+    auto invoke = [&]() {
+        pool.parallel_invoke([]() { throw std::runtime_error("a"); },
+                             [&b_done]() {
+                                 std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                                 b_done = true;
+                             });
+    };
+    EXPECT_THROW(invoke(), std::runtime_error);
+    EXPECT_TRUE(b_done);
+
+    b_done = false;
+    auto res = pool.submit([&]() {
+        try {
+            invoke();
+        } catch (const std::runtime_error&) {
+            return b_done.load();
+        }
+        return false;
+    });
+    EXPECT_TRUE(res.get());
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
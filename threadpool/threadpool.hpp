@@ -0,0 +1,356 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../function/function.hpp"
+#include "../deque/deque.hpp"
+
+namespace g {
+
+//==========================================
+// Chase-Lev work-stealing deque
+//
+// The owner pushes and pops at the bottom, thieves steal from the top.
+// Retired rings are kept until destruction, so a thief that read a stale ring pointer
+// still reads valid memory.
+
+template<typename T>
+class ws_deque {
+private:
+    struct ring {
+        explicit ring(int64_t capacity) : mask(capacity - 1), data(new std::atomic<T*>[capacity]) {}
+
+        T* get(int64_t i) const          { return data[i & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, T *val)      { data[i & mask].store(val, std::memory_order_relaxed); }
+        int64_t capacity() const         { return mask + 1; }
+
+        int64_t mask;
+        std::unique_ptr<std::atomic<T*>[]> data;
+    };
+
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    std::atomic<ring*> ring_;
+    std::vector<std::unique_ptr<ring>> rings_;
+
+public:
+    explicit ws_deque(int64_t capacity = 256) : top_(0), bottom_(0)
+    {
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+        rings_.emplace_back(new ring(capacity));
+        ring_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    ws_deque(const ws_deque &other) = delete;
+    ws_deque& operator=(const ws_deque &other) = delete;
+
+    // Owner only
+    void push(T *val)
+    {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        ring *r = ring_.load(std::memory_order_relaxed);
+        if (b - t > r->capacity() - 1)
+            r = grow(r, t, b);
+        r->put(b, val);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only, nullptr if empty
+    T* pop()
+    {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        ring *r = ring_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T *val = r->get(b);
+        if (t == b) {                               // last element, race against thieves
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                val = nullptr;
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return val;
+    }
+
+    // Any thread, nullptr if empty or lost a race
+    T* steal()
+    {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+
+        if (t >= b)
+            return nullptr;
+
+        T *val = ring_.load(std::memory_order_acquire)->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return val;
+    }
+
+    bool empty() const
+    {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+
+private:
+    ring* grow(ring *old, int64_t t, int64_t b)
+    {
+        ring *r = new ring(old->capacity() * 2);
+        for (int64_t i = t; i < b; ++i)
+            r->put(i, old->get(i));
+        rings_.emplace_back(r);
+        ring_.store(r, std::memory_order_release);
+        return r;
+    }
+};
+
+//==========================================
+// Thread pool
+
+class thread_pool {
+public:
+    using task_t = g::function<void()>;
+
+    explicit thread_pool(size_t threads = std::max(1u, std::thread::hardware_concurrency()));
+    ~thread_pool();
+
+    thread_pool(const thread_pool &other) = delete;
+    thread_pool& operator=(const thread_pool &other) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    // WARNING: blocking on the future from inside a pool task may deadlock, use parallel_invoke for nested work
+    template<typename FunctionT>
+    std::future<std::invoke_result_t<FunctionT>> submit(FunctionT func);
+
+    // Runs both callables, possibly in parallel; a worker keeps executing other tasks while it waits
+    template<typename FunctionA, typename FunctionB>
+    void parallel_invoke(FunctionA &&a, FunctionB &&b);
+
+    // Calls func(i) for every i in [first, last), splitting the range down to grain sized chunks
+    template<typename FunctionT>
+    void parallel_for(size_t first, size_t last, FunctionT func, size_t grain = 0);
+
+private:
+    struct worker {
+        ws_deque<task_t> tasks;
+        std::thread thread;
+        uint64_t seed;
+    };
+
+    std::vector<std::unique_ptr<worker>> workers_;
+
+    std::mutex shared_mutex_;
+    g::deque<task_t*> shared_tasks_;            // tasks submitted from outside of the pool
+
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+    std::atomic<size_t> pending_;               // queued tasks not yet taken by anybody
+    std::atomic<size_t> idle_;
+    std::atomic<bool> stop_;
+
+    static thread_pool*& current_pool() { thread_local thread_pool *pool = nullptr; return pool; }
+    static size_t& current_id()         { thread_local size_t id = -1; return id; }
+
+    bool in_worker() const { return current_pool() == this; }
+
+    void push(task_t *task);
+    task_t* find_task(size_t id);
+    void run(task_t *task) { (*task)(); delete task; }
+    void worker_loop(size_t id);
+
+    template<typename FunctionT>
+    void parallel_for_rec(size_t first, size_t last, FunctionT &func, size_t grain);
+};
+
+inline thread_pool::thread_pool(size_t threads) : shared_tasks_(), pending_(0), idle_(0), stop_(false)
+{
+    assert(threads > 0);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(new worker());
+        workers_.back()->seed = 0x9E3779B97F4A7C15ull * (i + 1);
+    }
+    for (size_t i = 0; i < threads; ++i)
+        workers_[i]->thread = std::thread(&thread_pool::worker_loop, this, i);
+}
+
+inline thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        stop_.store(true);
+    }
+    park_cv_.notify_all();
+    for (auto &w : workers_)
+        w->thread.join();
+}
+
+template<typename FunctionT>
+std::future<std::invoke_result_t<FunctionT>> thread_pool::submit(FunctionT func)
+{
+    using Ret = std::invoke_result_t<FunctionT>;
+    auto job = std::make_shared<std::packaged_task<Ret()>>(std::move(func));
+    std::future<Ret> result = job->get_future();
+    push(new task_t([job]() { (*job)(); }));
+    return result;
+}
+
+template<typename FunctionA, typename FunctionB>
+void thread_pool::parallel_invoke(FunctionA &&a, FunctionB &&b)
+{
+    if (!in_worker()) {
+        std::future<void> fut = submit([&b]() { b(); });
+        try {
+            a();
+        } catch (...) {
+            fut.wait();                             // b references our frame, so it has to finish first
+            throw;
+        }
+        fut.get();
+        return;
+    }
+
+    std::atomic<bool> done(false);
+    std::exception_ptr error;
+    push(new task_t([&]() {
+        try {
+            b();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        done.store(true, std::memory_order_release);
+    }));
+
+    try {
+        a();
+    } catch (...) {
+        while (!done.load(std::memory_order_acquire)) {  // b references our frame, so it has to finish first
+            if (task_t *task = find_task(current_id()))
+                run(task);
+            else
+                std::this_thread::yield();
+        }
+        throw;
+    }
+
+    while (!done.load(std::memory_order_acquire)) {
+        if (task_t *task = find_task(current_id()))
+            run(task);
+        else
+            std::this_thread::yield();
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+template<typename FunctionT>
+void thread_pool::parallel_for(size_t first, size_t last, FunctionT func, size_t grain)
+{
+    if (first >= last)
+        return;
+    if (grain == 0)
+        grain = std::max<size_t>(1, (last - first) / (8 * size()));
+    parallel_for_rec(first, last, func, grain);
+}
+
+template<typename FunctionT>
+void thread_pool::parallel_for_rec(size_t first, size_t last, FunctionT &func, size_t grain)
+{
+    if (last - first <= grain) {
+        for (size_t i = first; i < last; ++i)
+            func(i);
+        return;
+    }
+    size_t mid = first + (last - first) / 2;
+    parallel_invoke([&]() { parallel_for_rec(first, mid, func, grain); },
+                    [&]() { parallel_for_rec(mid,  last, func, grain); });
+}
+
+inline void thread_pool::push(task_t *task)
+{
+    if (in_worker()) {
+        workers_[current_id()]->tasks.push(task);
+    } else {
+        std::lock_guard<std::mutex> lock(shared_mutex_);
+        shared_tasks_.push_back(task);
+    }
+
+    pending_.fetch_add(1);
+    if (idle_.load() > 0) {
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        park_cv_.notify_one();
+    }
+}
+
+inline thread_pool::task_t* thread_pool::find_task(size_t id)
+{
+    task_t *task = workers_[id]->tasks.pop();
+
+    if (task == nullptr) {
+        std::lock_guard<std::mutex> lock(shared_mutex_);
+        if (shared_tasks_.size() != 0)
+            task = shared_tasks_.pop_front();
+    }
+
+    for (size_t attempt = 0; task == nullptr && attempt < 2 * workers_.size(); ++attempt) {
+        uint64_t &x = workers_[id]->seed;           // xorshift64 victim selection
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        size_t victim = x % workers_.size();
+        if (victim != id)
+            task = workers_[victim]->tasks.steal();
+    }
+
+    if (task != nullptr)
+        pending_.fetch_sub(1);
+    return task;
+}
+
+inline void thread_pool::worker_loop(size_t id)
+{
+    current_pool() = this;
+    current_id() = id;
+
+    while (true) {
+        if (task_t *task = find_task(id)) {
+            run(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        if (stop_.load() && pending_.load() == 0)
+            break;
+        idle_.fetch_add(1);
+        park_cv_.wait(lock, [this]() { return stop_.load() || pending_.load() > 0; });
+        idle_.fetch_sub(1);
+    }
+
+    current_pool() = nullptr;
+    current_id() = -1;
+}
+
+} // namespace g
+#endif
@@ -0,0 +1,54 @@
+#include "timerwheel.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Usage: timerwheel-bench [timers = 10000000] [horizon in ticks = 16777216]
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    size_t   n       = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    uint64_t horizon = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1 << 24;
+
+    std::mt19937_64 rnd(179);
+    std::vector<uint64_t> expires(n);
+    for (auto &e : expires)
+        e = rnd() % horizon + 1;
+
+    size_t counter = 0;
+    auto callback = [&counter]() { ++counter; };
+    g::MemPool callbacks(g::function<void()>::holder_size<decltype(callback)>(), n);
+
+    g::timer_wheel W(0, n);
+    std::vector<g::timer_wheel::timer_id> ids(n);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+        ids[i] = W.arm(expires[i], g::function<void()>(callback, callbacks));
+    double arm_time = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i += 2)
+        W.cancel(ids[i]);
+    double cancel_time = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t fired = 0;
+    for (uint64_t now = 0; now <= horizon; now += 64)
+        fired += W.advance(now);
+    fired += W.advance(horizon + 1);
+    double expire_time = seconds_since(start);
+
+    printf("timers  %zu, horizon %llu ticks\n", n, (unsigned long long)horizon);
+    printf("arm     %8.2f Mops/s\n", n / arm_time / 1e6);
+    printf("cancel  %8.2f Mops/s\n", (n + 1) / 2 / cancel_time / 1e6);
+    printf("expire  %8.2f Mops/s (%zu fired)\n", fired / expire_time / 1e6, counter);
+    return fired == n / 2 ? 0 : 1;
+}
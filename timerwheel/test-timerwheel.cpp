@@ -0,0 +1,110 @@
+#include "timerwheel.hpp"
+#include "../treap/treap.hpp"           // each defines its own pool, they must not clash
+#include <map>
+#include <vector>
+#include <random>
+#include "gtest/gtest.h"
+
+std::mt19937_64 rnd(179);
+
+TEST(Basics, FireInOrder) {
+    g::timer_wheel W;
+    std::vector<int> fired;
+    W.arm(5,   [&]() { fired.push_back(5); });
+    W.arm(300, [&]() { fired.push_back(300); });
+    W.arm(1,   [&]() { fired.push_back(1); });
+    W.arm(70000, [&]() { fired.push_back(70000); });
+    EXPECT_EQ(W.size(), 4);
+
+    EXPECT_EQ(W.advance(4), 1);
+    EXPECT_EQ(fired, std::vector<int>({1}));
+    EXPECT_EQ(W.advance(299), 1);
+    EXPECT_EQ(W.advance(300), 1);
+    EXPECT_EQ(W.advance(69999), 0);
+    EXPECT_EQ(W.advance(70000), 1);
+    EXPECT_EQ(fired, std::vector<int>({1, 5, 300, 70000}));
+    EXPECT_EQ(W.size(), 0);
+    EXPECT_EQ(W.now(), 70000);
+}
+
+TEST(Basics, Cancel) {
+    g::timer_wheel W(100);
+    int fired = 0;
+    auto a = W.arm(150, [&]() { ++fired; });
+    auto b = W.arm(150, [&]() { fired += 10; });
+    auto c = W.arm(100000, [&]() { fired += 100; });
+    EXPECT_TRUE(W.cancel(b));
+    EXPECT_FALSE(W.cancel(b));
+    EXPECT_TRUE(W.cancel(c));
+    EXPECT_EQ(W.advance(1000000), 1);
+    EXPECT_EQ(fired, 1);
+    EXPECT_FALSE(W.cancel(a));
+
+    auto d = W.arm(W.now() + 1, [&]() { fired += 1000; });    // reuses a freed slot
+    EXPECT_FALSE(W.cancel(a));
+    EXPECT_TRUE(W.cancel(d));
+}
+
+TEST(Basics, CallbacksRearmAndCancel) {
+    g::timer_wheel W;
+    int ticks = 0, rearms = 0;
+    g::timer_wheel::timer_id victim;
+    std::function<void()> tick = [&]() {
+        ++ticks;
+        if (++rearms < 10)
+            W.arm(W.now() + 1000, [&]() { tick(); });
+    };
+    W.arm(10, [&]() { tick(); });
+    W.arm(10, [&]() { W.cancel(victim); });
+    victim = W.arm(11, [&]() { ticks += 1000; });
+    W.arm(3, [&]() { W.arm(0, [&]() { ticks += 100; }); });
+
+    W.advance(3);
+    EXPECT_EQ(ticks, 0);
+    W.advance(4);
+    EXPECT_EQ(ticks, 100);
+    W.advance(100000);
+    EXPECT_EQ(ticks, 110);
+}
+
+TEST(Random, AgainstMultimap) {
+    for (int k = 0; k < 10; ++k){
+        g::timer_wheel W(rnd() % 1000);
+        std::multimap<uint64_t, size_t> M;
+        std::vector<std::pair<g::timer_wheel::timer_id, std::multimap<uint64_t, size_t>::iterator>> armed;
+        std::vector<size_t> fired;
+
+        for (size_t i = 0; i < 20000; ++i){
+            int shift = rnd() % 5;
+            uint64_t expire = W.now() + rnd() % (uint64_t(1) << (8 * shift + 4)) + 1;
+            auto id = W.arm(expire, [&fired, i]() { fired.push_back(i); });
+            armed.push_back({id, M.insert({expire, i})});
+        }
+        for (size_t i = 0; i < armed.size(); i += 3){
+            EXPECT_TRUE(W.cancel(armed[i].first));
+            M.erase(armed[i].second);
+        }
+
+        uint64_t now = W.now();
+        while (!M.empty()){
+            now += rnd() % (uint64_t(1) << (rnd() % 40)) + 1;
+            fired.clear();
+            W.advance(now);
+            std::vector<size_t> expected;
+            while (!M.empty() && M.begin()->first <= now){
+                expected.push_back(M.begin()->second);
+                M.erase(M.begin());
+            }
+            std::sort(fired.begin(), fired.end());
+            std::sort(expected.begin(), expected.end());
+            EXPECT_EQ(fired, expected);
+            EXPECT_EQ(W.size(), M.size());
+        }
+    }
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,261 @@
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../function/function.hpp"
+
+namespace g {
+
+//==========================================
+// Hierarchical timing wheel
+//
+// Time is measured in abstract ticks. Level k has 256 buckets of 256^k ticks each,
+// a timer is kept in the coarsest level that still resolves it and moves down a level
+// when its bucket comes up (cascading a whole bucket at once). Buckets are intrusive
+// doubly-linked lists of nodes kept in a vector with a free list, so arm and cancel are O(1).
+
+class timer_wheel {
+public:
+    static constexpr size_t LEVELS      = 4;
+    static constexpr size_t SLOT_BITS   = 8;
+    static constexpr size_t SLOTS       = 1 << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint64_t MAX_DELTA = uint64_t(1) << (SLOT_BITS * LEVELS);
+
+    struct timer_id {
+        size_t   id     = -1;
+        uint64_t serial = 0;
+    };
+
+    explicit timer_wheel(uint64_t now = 0, size_t capacity = 1024);
+
+    timer_wheel(const timer_wheel &other) = delete;
+    timer_wheel& operator=(const timer_wheel &other) = delete;
+
+    // Expirations at or before now() fire on the next advance
+    timer_id arm( uint64_t expire, g::function<void()> callback );
+    bool     cancel( timer_id timer );
+
+    // Fires every timer with expire <= now, returns the number of fired timers
+    size_t advance( uint64_t now );
+
+    uint64_t now()  const { return now_; }
+    size_t   size() const { return size_; }
+
+private:
+    struct Node {
+        uint64_t expire;
+        uint64_t serial;                // 0 while the node is free
+        size_t prev, next;
+        size_t bucket;
+        g::function<void()> callback;
+    };
+
+    struct bitmap {
+        uint64_t words[SLOTS / 64] = {};
+
+        void set  (size_t i)       { words[i / 64] |=  (uint64_t(1) << (i % 64)); }
+        void reset(size_t i)       { words[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+
+        // distance in [1, SLOTS] from `from` to the next set slot going forward cyclically, 0 if none
+        size_t next(size_t from) const;
+    };
+
+    std::vector<Node> nodes_;           // growing may move nodes, so no references are held across alloc
+    size_t   free_;                     // free nodes are chained through next
+    size_t   heads_[LEVELS][SLOTS];
+    bitmap   occupied_[LEVELS];
+    uint64_t now_;
+    uint64_t serial_;
+    size_t   size_;
+
+    size_t alloc ();
+    void   free  ( size_t id );
+    void   place ( size_t id );
+    void   link  ( size_t id, size_t bucket );
+    void   unlink( size_t id );
+    size_t detach( size_t bucket );
+    void   cascade( size_t level );
+    size_t fire( size_t slot );
+
+    uint64_t next_event() const;
+};
+
+inline size_t timer_wheel::bitmap::next(size_t from) const
+{
+    size_t start = (from + 1) & SLOT_MASK;
+    size_t word  = start / 64;
+    uint64_t w   = words[word] & (~uint64_t(0) << (start % 64));
+    for (size_t i = 0; i <= SLOTS / 64; ++i) {
+        if (w) {
+            size_t dist = (word * 64 + std::countr_zero(w) - from) & SLOT_MASK;
+            return dist ? dist : SLOTS;
+        }
+        word = (word + 1) % (SLOTS / 64);
+        w = words[word];
+    }
+    return 0;
+}
+
+inline timer_wheel::timer_wheel(uint64_t now, size_t capacity) :
+    free_(-1),
+    now_(now),
+    serial_(0),
+    size_(0)
+{
+    nodes_.reserve(capacity);
+    for (size_t level = 0; level < LEVELS; ++level)
+        std::fill(heads_[level], heads_[level] + SLOTS, size_t(-1));
+}
+
+inline size_t timer_wheel::alloc()
+{
+    if (free_ == size_t(-1)) {
+        nodes_.emplace_back();
+        return nodes_.size() - 1;
+    }
+    return std::exchange(free_, nodes_[free_].next);
+}
+
+inline void timer_wheel::free(size_t id)
+{
+    Node &v = nodes_[id];
+    v.serial = 0;
+    v.callback = g::function<void()>();
+    v.next = std::exchange(free_, id);
+}
+
+inline timer_wheel::timer_id timer_wheel::arm(uint64_t expire, g::function<void()> callback)
+{
+    size_t id = alloc();
+    nodes_[id] = Node{std::max(expire, now_ + 1), ++serial_, size_t(-1), size_t(-1), 0, std::move(callback)};
+    place(id);
+    ++size_;
+    return {id, serial_};
+}
+
+inline bool timer_wheel::cancel(timer_id timer)
+{
+    if (timer.id >= nodes_.size() || timer.serial == 0 || nodes_[timer.id].serial != timer.serial)
+        return false;
+    unlink(timer.id);
+    free(timer.id);
+    --size_;
+    return true;
+}
+
+inline size_t timer_wheel::advance(uint64_t now)
+{
+    size_t fired = 0;
+    while (now_ < now) {
+        uint64_t next = size_ ? next_event() : now;
+        if (next > now) {
+            now_ = now;
+            break;
+        }
+        now_ = next;
+        for (size_t level = 1; level < LEVELS && (now_ & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0; ++level)
+            cascade(level);
+        fired += fire(now_ & SLOT_MASK);
+    }
+    return fired;
+}
+
+inline uint64_t timer_wheel::next_event() const
+{
+    uint64_t best = -1;
+    for (size_t level = 0; level < LEVELS; ++level) {
+        size_t shift = SLOT_BITS * level;
+        uint64_t base = now_ >> shift;
+        size_t dist = occupied_[level].next(base & SLOT_MASK);
+        if (dist == 0)
+            continue;
+        best = std::min(best, (base + dist) << shift);
+    }
+    return best;
+}
+
+inline void timer_wheel::place(size_t id)
+{
+    Node &v = nodes_[id];
+    uint64_t expire = v.expire;
+    if (expire - now_ >= MAX_DELTA)
+        expire = now_ + MAX_DELTA - 1;      // parked in the top level, re-placed on cascade
+
+    uint64_t delta = expire - now_;
+    size_t level = 0;
+    while (level + 1 < LEVELS && (delta >> (SLOT_BITS * (level + 1))) != 0)
+        ++level;
+
+    link(id, level * SLOTS + ((expire >> (SLOT_BITS * level)) & SLOT_MASK));
+}
+
+inline void timer_wheel::link(size_t id, size_t bucket)
+{
+    size_t &head = heads_[bucket / SLOTS][bucket % SLOTS];
+    Node &v = nodes_[id];
+    v.bucket = bucket;
+    v.prev = -1;
+    v.next = head;
+    if (head != size_t(-1))
+        nodes_[head].prev = id;
+    else
+        occupied_[bucket / SLOTS].set(bucket % SLOTS);
+    head = id;
+}
+
+inline void timer_wheel::unlink(size_t id)
+{
+    Node &v = nodes_[id];
+    size_t &head = heads_[v.bucket / SLOTS][v.bucket % SLOTS];
+    if (v.prev != size_t(-1))
+        nodes_[v.prev].next = v.next;
+    else
+        head = v.next;
+    if (v.next != size_t(-1))
+        nodes_[v.next].prev = v.prev;
+    if (head == size_t(-1))
+        occupied_[v.bucket / SLOTS].reset(v.bucket % SLOTS);
+}
+
+inline size_t timer_wheel::detach(size_t bucket)
+{
+    occupied_[bucket / SLOTS].reset(bucket % SLOTS);
+    return std::exchange(heads_[bucket / SLOTS][bucket % SLOTS], size_t(-1));
+}
+
+inline void timer_wheel::cascade(size_t level)
+{
+    size_t id = detach(level * SLOTS + ((now_ >> (SLOT_BITS * level)) & SLOT_MASK));
+    while (id != size_t(-1)) {
+        size_t next = nodes_[id].next;
+        place(id);
+        id = next;
+    }
+}
+
+inline size_t timer_wheel::fire(size_t slot)
+{
+    size_t fired = 0;
+    size_t &head = heads_[0][slot];
+    while (head != size_t(-1)) {                // callbacks may arm and cancel timers, so pop one at a time
+        size_t id = head;
+        unlink(id);
+        g::function<void()> callback = std::move(nodes_[id].callback);
+        free(id);
+        --size_;
+        ++fired;
+        callback();
+    }
+    return fired;
+}
+
+} // namespace g
+#endif
@@ -0,0 +1,72 @@
+#include "treap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Usage: frozen-bench [keys...] (default 1000000 10000000 100000000)
+// Random successful lookups: treap::find, frozen_map::find and std::lower_bound over a sorted array.
+// The treap is skipped above 20M keys, where its nodes alone outgrow a small machine.
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i)
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    if (sizes.empty())
+        sizes = {1000000, 10000000, 100000000};
+
+    const size_t queries = 4000000;
+    std::printf("%-12s %14s %14s %14s\n", "Mlookups/s", "treap", "frozen_map", "sorted array");
+    for (size_t n : sizes) {
+        std::vector<std::pair<int, int>> items(n);
+        for (size_t i = 0; i < n; ++i)
+            items[i] = {int(2 * i), int(i)};
+        std::vector<int> keys(n);
+        for (size_t i = 0; i < n; ++i)
+            keys[i] = items[i].first;
+
+        std::mt19937 rnd(179);
+        std::vector<int> probes(queries);
+        for (auto &p : probes)
+            p = 2 * int(rnd() % n);
+
+        long long sum = 0;
+        double treap_rate = 0;
+        if (n <= 20000000) {
+            g::treap<int, int> T;
+            T.build_sorted(items.begin(), items.end());
+            auto start = std::chrono::steady_clock::now();
+            for (int p : probes)
+                sum += *T.find(p);
+            treap_rate = queries / seconds_since(start) / 1e6;
+        }
+
+        g::frozen_map<int, int> F(items.begin(), items.end());
+        items.clear();
+        items.shrink_to_fit();
+        auto start = std::chrono::steady_clock::now();
+        for (int p : probes)
+            sum += *F.find(p);
+        double frozen_rate = queries / seconds_since(start) / 1e6;
+
+        start = std::chrono::steady_clock::now();
+        for (int p : probes)
+            sum += *std::lower_bound(keys.begin(), keys.end(), p) / 2;
+        double array_rate = queries / seconds_since(start) / 1e6;
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%zuM keys", n / 1000000);
+        if (treap_rate)
+            std::printf("%-12s %14.2f %14.2f %14.2f   (%lld)\n", name, treap_rate, frozen_rate, array_rate, sum);
+        else
+            std::printf("%-12s %14s %14.2f %14.2f   (%lld)\n", name, "-", frozen_rate, array_rate, sum);
+    }
+}
@@ -0,0 +1,63 @@
+#include "persistent_treap.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Usage: persistent-bench [keys = 1000000]
+// Cost of a snapshot against copying a g::treap, and of updates while snapshots are alive
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::printf("%zu keys\n", n);
+
+    std::mt19937 rnd(179);
+    std::vector<int> keys(n);
+    for (auto &k : keys)
+        k = rnd();
+
+    g::treap<int, int> T;
+    g::persistent_treap<int, int> P;
+    for (int k : keys) {
+        T.insert(k, k);
+        P.insert(k, k);
+    }
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        g::treap<int, int> copy(T);
+        double copy_time = seconds_since(start);
+        start = std::chrono::steady_clock::now();
+        auto snap = P.snapshot();
+        std::printf("treap copy %10.3f ms, snapshot %10.6f ms\n", copy_time * 1e3, seconds_since(start) * 1e3);
+    }
+
+    std::printf("%-24s %14s\n", "", "insert Mops/s");
+    for (size_t every : {size_t(0), size_t(1000), size_t(1)}) {
+        std::vector<g::persistent_treap<int, int>> snaps;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            P.insert(keys[i] ^ 1, int(i));
+            if (every && i % every == 0) {
+                if (snaps.size() == 16)
+                    snaps.erase(snaps.begin());
+                snaps.push_back(P.snapshot());
+            }
+        }
+        char name[64];
+        if (every)
+            std::snprintf(name, sizeof(name), "snapshot every %zu", every);
+        else
+            std::snprintf(name, sizeof(name), "no snapshots");
+        std::printf("%-24s %14.2f\n", name, n / seconds_since(start) / 1e6);
+        for (size_t i = 0; i < n; ++i)
+            P.erase(keys[i] ^ 1);
+    }
+}
@@ -0,0 +1,49 @@
+#include "rope.hpp"
+#include "../deque/deque.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Usage: rope-bench [elements = 100000]
+// Random-position insert and erase, g::rope against g::deque
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    std::printf("%zu elements\n", n);
+    std::printf("%-8s %14s %14s\n", "", "insert Mops/s", "erase Mops/s");
+
+    {
+        std::mt19937 rnd(179);
+        g::rope<int> R;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i)
+            R.insert_at(rnd() % (i + 1), int(i));
+        double insert_time = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = n; i > 0; --i)
+            R.erase_at(rnd() % i);
+        std::printf("%-8s %14.2f %14.2f\n", "rope", n / insert_time / 1e6, n / seconds_since(start) / 1e6);
+    }
+
+    {
+        std::mt19937 rnd(179);
+        g::deque<int> D;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i)
+            D.insert(rnd() % (i + 1), int(i));
+        double insert_time = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = n; i > 0; --i)
+            D.erase(rnd() % i);
+        std::printf("%-8s %14.2f %14.2f\n", "deque", n / insert_time / 1e6, n / seconds_since(start) / 1e6);
+    }
+}
@@ -0,0 +1,57 @@
+#include "treap_setops.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Usage: setops-bench [keys = 1000000]
+// Union, intersection and difference of two random sets of the given size, sequential and on 1-8 workers
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static g::treap<int, int> random_treap(size_t n, std::mt19937 &rnd)
+{
+    std::vector<int> keys(n);
+    for (auto &k : keys)
+        k = rnd() % (4 * n);
+    std::sort(keys.begin(), keys.end());
+    g::treap<int, int> T;
+    T.build_sorted(keys.begin(), keys.end());
+    return T;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::mt19937 rnd(179);
+    g::treap<int, int> A = random_treap(n, rnd), B = random_treap(n, rnd);
+    std::printf("%zu and %zu keys\n", A.size(), B.size());
+
+    auto run = [&](const char *name, g::thread_pool *pool) {
+        double times[3];
+        for (int o = 0; o < 3; ++o) {
+            g::treap<int, int> a = A, b = B;            // copies are not timed
+            auto start = std::chrono::steady_clock::now();
+            g::treap<int, int> R = (o == 0 ? g::treap_union(std::move(a), std::move(b), pool)
+                                  : o == 1 ? g::treap_intersection(std::move(a), std::move(b), pool)
+                                           : g::treap_difference(std::move(a), std::move(b), pool));
+            times[o] = seconds_since(start);
+        }
+        std::printf("%-12s %10.1f %10.1f %10.1f\n", name, times[0] * 1e3, times[1] * 1e3, times[2] * 1e3);
+    };
+
+    std::printf("%-12s %10s %10s %10s\n", "ms", "union", "intersect", "difference");
+    run("sequential", nullptr);
+    for (size_t threads : {1, 2, 4, 8}) {
+        g::thread_pool pool(threads);
+        char name[32];
+        std::snprintf(name, sizeof(name), "%zu threads", threads);
+        run(name, &pool);
+    }
+}
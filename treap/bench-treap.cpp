@@ -0,0 +1,75 @@
+#include "treap.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Usage: treap-bench [keys = 1000000]
+// Built twice: treap-bench uses the iterative split/merge, treap-bench-recursive the recursive one
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    #ifdef TREAP_RECURSIVE_SPLIT_MERGE
+    std::printf("recursive split/merge, %zu keys\n", n);
+    #else
+    std::printf("iterative split/merge, %zu keys\n", n);
+    #endif
+
+    std::mt19937 rnd(179);
+    std::vector<int> random_keys(n), sorted_keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        random_keys[i] = rnd();
+        sorted_keys[i] = int(i);
+    }
+
+    std::printf("%-8s %14s %14s\n", "keys", "insert Mops/s", "erase Mops/s");
+    for (auto *keys : {&random_keys, &sorted_keys}) {
+        g::treap<int, int> T;
+        auto start = std::chrono::steady_clock::now();
+        for (int k : *keys)
+            T.insert(k, k);
+        double insert_time = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int k : *keys)
+            T.erase(k);
+        double erase_time = seconds_since(start);
+
+        std::printf("%-8s %14.2f %14.2f\n", keys == &random_keys ? "random" : "sorted", n / insert_time / 1e6, n / erase_time / 1e6);
+    }
+
+    {
+        g::treap<int, int> T;
+        auto start = std::chrono::steady_clock::now();
+        T.build_sorted(sorted_keys.begin(), sorted_keys.end());
+        std::printf("%-8s %14.2f\n", "bulk", n / seconds_since(start) / 1e6);
+    }
+
+    {
+        // Full in-order scans of a randomly built treap, whose nodes are scattered over the pool
+        g::treap<int, int> T;
+        for (int k : random_keys)
+            T.insert(k, k);
+
+        long long sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto iter = T.begin(); iter != T.end(); ++iter)
+            sum += (*iter).second;
+        double iter_time = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        T.for_each([&sum](const int &, int &val) { sum += val; });
+        double for_each_time = seconds_since(start);
+
+        std::printf("%-8s %14s %14s\n", "scan", "Iterator Mk/s", "for_each Mk/s");
+        std::printf("%-8s %14.2f %14.2f   (%lld)\n", "random", T.size() / iter_time / 1e6, T.size() / for_each_time / 1e6, sum);
+    }
+}
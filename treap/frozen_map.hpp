@@ -0,0 +1,176 @@
+#ifndef FROZEN_MAP_HPP
+#define FROZEN_MAP_HPP
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace g {
+
+//==================================
+// Frozen map
+//
+// An immutable sorted map in Eytzinger (BFS) order: the children of slot k are 2k and 2k + 1, so a
+// search walks down one implicit tree whose top levels share a few cache lines. The descent has no
+// data-dependent branch and prefetches the line that holds all descendants of the current slot a
+// few levels down, so the loads of successive levels overlap. Keys and values are kept apart and
+// slot 0 sits on a cache line boundary, so the search only touches key lines.
+
+template<typename Key, typename Data>
+class frozen_map
+{
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    // The s descendants of slot k that lie log2(s) levels down are slots s*k .. s*k + s - 1
+    static constexpr size_t PREFETCH_STRIDE = (sizeof(Key) * 2 <= CACHE_LINE ? CACHE_LINE / sizeof(Key) : 2);
+
+    std::vector<Key>  storage;                      // keys with padding in front to align slot 0
+    const Key        *keys;                         // 1-based, keys[0] is unused
+    std::vector<Data> vals;
+    size_t n;
+
+    void allocate( size_t count )
+    {
+        size_t pad = CACHE_LINE / sizeof(Key) + 1;
+        storage.assign(count + pad, Key());
+        size_t offset = 0;
+        while (offset + 1 < pad && reinterpret_cast<uintptr_t>(storage.data() + offset) % CACHE_LINE != 0)
+            ++offset;
+        keys = storage.data() + offset;
+        vals.assign(count, Data());
+    }
+
+public:
+    struct Iterator
+    {
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::pair<const Key, const Data>;
+
+        Iterator( size_t k = 0, const frozen_map *this_ = nullptr ) : k(k), this_(this_) {}
+
+        bool operator==( const Iterator &other ) const { return k == other.k; }
+        bool operator!=( const Iterator &other ) const { return k != other.k; }
+
+        std::pair<const Key&, const Data&> operator*() const { return {this_->keys[k], this_->vals[k]}; }
+
+        // In-order successor: leftmost slot of the right subtree, or the first ancestor we are left of
+        Iterator& operator++()
+        {
+            assert(k != 0);
+            if (2 * k + 1 <= this_->n) {
+                k = 2 * k + 1;
+                while (2 * k <= this_->n)
+                    k = 2 * k;
+            }
+            else
+                k >>= std::countr_one(k) + 1;
+            return (*this);
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator result(*this);
+            ++(*this);
+            return result;
+        }
+
+    private:
+        size_t k;                                   // 0 is end
+        const frozen_map* this_;
+    };
+
+    Iterator begin() const
+    {
+        size_t k = 1;
+        while (2 * k <= n)
+            k = 2 * k;
+        return Iterator(n ? k : 0, this);
+    }
+    Iterator end() const { return Iterator(0, this); }
+
+
+    //======================================
+    // FROZEN MAP interface functions
+
+    frozen_map() : n(0) { allocate(1); }
+    frozen_map( const frozen_map &other ) = delete;                 // keys point into storage, move only
+    frozen_map( frozen_map &&other ) : storage(std::move(other.storage)), keys(other.keys), vals(std::move(other.vals)),
+                                       n(std::exchange(other.n, 0)) {}
+    frozen_map& operator=( const frozen_map &other ) = delete;
+    frozen_map& operator=( frozen_map &&other )
+    {
+        storage = std::move(other.storage);
+        keys = other.keys;
+        vals = std::move(other.vals);
+        n = std::exchange(other.n, 0);
+        return (*this);
+    }
+
+    // [first, last) holds (key, value) pairs in strictly ascending key order
+    template<typename ForwardIt>
+    frozen_map( ForwardIt first, ForwardIt last );
+
+    size_t size()  const { return n; }
+    bool   empty() const { return n == 0; }
+
+    Iterator lower_bound( const Key &x ) const { return Iterator(search<false>(x), this); }
+    Iterator upper_bound( const Key &x ) const { return Iterator(search<true>(x),  this); }
+
+    // Read-only, unlike treap::find, since the map is immutable
+    const Data* find( const Key &x ) const
+    {
+        size_t k = search<false>(x);
+        return (k != 0 && !(x < keys[k])) ? &vals[k] : nullptr;
+    }
+    bool contains( const Key &x ) const { return find(x) != nullptr; }
+
+private:
+    // Slot of the first key not less than x (greater than x for Upper), 0 if there is none
+    template<bool Upper>
+    size_t search( const Key &x ) const
+    {
+        size_t k = 1;
+        while (k <= n) {
+            __builtin_prefetch(keys + k * PREFETCH_STRIDE);         // may point past the end, which is harmless
+            k = 2 * k + (Upper ? !(x < keys[k]) : keys[k] < x);
+        }
+        // Past the answer the path turned left once and then only right: strip those bits from k
+        return k >> (std::countr_one(k) + 1);
+    }
+};
+
+
+template<typename Key, typename Data>
+template<typename ForwardIt>
+frozen_map<Key, Data>::frozen_map(ForwardIt first, ForwardIt last)
+{
+    n = std::distance(first, last);
+    allocate(n + 1);
+    Key *slots = storage.data() + (keys - storage.data());
+
+    // In-order walk over the implicit tree, which visits slots in key order
+    size_t k = 1;
+    while (2 * k <= n)
+        k = 2 * k;
+    for (; first != last; ++first) {
+        assert(k != 0);
+        slots[k] = (*first).first;
+        vals[k] = (*first).second;
+        if (2 * k + 1 <= n) {
+            k = 2 * k + 1;
+            while (2 * k <= n)
+                k = 2 * k;
+        }
+        else
+            k >>= std::countr_one(k) + 1;
+    }
+}
+
+} // namespace g
+#endif
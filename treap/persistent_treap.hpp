@@ -0,0 +1,338 @@
+#ifndef PERSISTENT_TREAP_HPP
+#define PERSISTENT_TREAP_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "treap.hpp"
+#include "../objpool/atomicobjpool.hpp"
+
+namespace g {
+
+//==================================
+// Persistent treap
+//
+// Every copy is a version that shares its nodes with the one it came from, so copying is O(1).
+// Updates copy only the O(log n) nodes on the path they change: a node is modified in place
+// when its reference count shows that nothing else can see it, and copied otherwise.
+// Nodes count the parents and versions that point at them; a node whose count drops to zero
+// releases its children and goes back to the pool on whichever thread dropped it.
+//
+// A version may be read by any number of threads while another version is updated. Taking a copy
+// counts as a read, so the writer takes snapshots itself and hands them to the readers.
+
+template<typename Key, typename Data>
+class persistent_treap
+{
+private:
+    static constexpr uint32_t NIL = AtomicObjPool<int>::NIL;
+
+    struct Node
+    {
+        Key x;
+        Data val;
+        uint64_t prior;
+        uint32_t left, right;
+        uint32_t size;
+        std::atomic<uint32_t> refs;
+
+        Node(Key x, Data val, uint64_t prior, uint32_t left = NIL, uint32_t right = NIL, uint32_t size = 1)
+            : x(std::move(x)), val(std::move(val)), prior(prior), left(left), right(right), size(size), refs(1) {}
+    };
+
+    using pool_t = AtomicObjPool<Node>;
+
+    uint32_t root_id;
+    std::shared_ptr<pool_t> pool;
+    uint64_t seed;
+
+public:
+    struct Iterator
+    {
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::pair<const Key, const Data>;
+
+        Iterator() : this_(nullptr) {}
+        Iterator( uint32_t root, const persistent_treap *this_ ) : this_(this_) { descend(root); }
+
+        bool operator==( const Iterator &other ) const
+        {
+            if (stack.empty() || other.stack.empty())
+                return stack.empty() == other.stack.empty();
+            return stack.back() == other.stack.back();
+        }
+        bool operator!=( const Iterator &other ) const { return !((*this) == other); }
+
+        std::pair<const Key&, const Data&> operator*() const
+        {
+            const Node &v = this_->node(stack.back());
+            return {v.x, v.val};
+        }
+
+        Iterator& operator++()
+        {
+            assert(!stack.empty());
+            uint32_t id = stack.back();
+            stack.pop_back();
+            descend(this_->node(id).right);
+            return (*this);
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator result(*this);
+            ++(*this);
+            return result;
+        }
+
+    private:
+        std::vector<uint32_t> stack;                // path of pending ancestors, the top is current
+        const persistent_treap* this_;
+
+        void descend( uint32_t id )
+        {
+            for (; id != NIL; id = this_->node(id).left)
+                stack.push_back(id);
+        }
+    };
+
+    Iterator begin() const { return Iterator(root_id, this); }
+    Iterator end()   const { return Iterator(); }
+
+
+    //======================================
+    // PERSISTENT TREAP interface functions
+
+    persistent_treap() : root_id(NIL), pool(std::make_shared<pool_t>()), seed(detail::treap_seed()) {}
+    persistent_treap( const persistent_treap &other ) : root_id(other.root_id), pool(other.pool), seed(detail::treap_seed()) { retain(root_id); }
+    persistent_treap( persistent_treap &&other ) : root_id(std::exchange(other.root_id, NIL)), pool(other.pool), seed(other.seed) {}
+    ~persistent_treap() { release(root_id); }
+
+    persistent_treap& operator=( const persistent_treap &other )
+    {
+        if (this != &other) {
+            other.retain(other.root_id);
+            release(root_id);
+            root_id = other.root_id;
+            pool = other.pool;
+        }
+        return (*this);
+    }
+
+    persistent_treap& operator=( persistent_treap &&other )
+    {
+        if (this != &other) {
+            release(root_id);
+            root_id = std::exchange(other.root_id, NIL);
+            pool = other.pool;
+        }
+        return (*this);
+    }
+
+    // Immutable view of the current version; O(1)
+    persistent_treap snapshot() const { return *this; }
+
+    size_t size()  const { return root_id == NIL ? 0 : node(root_id).size; }
+    bool   empty() const { return root_id == NIL; }
+
+    void   insert( Key x, Data val );           // assigns val if x is present
+    bool   erase ( const Key &x );
+    void   clear () { release(std::exchange(root_id, NIL)); }
+
+    const Data* find( const Key &x ) const;
+    bool contains( const Key &x ) const { return find(x) != nullptr; }
+
+private:
+    Node& node( uint32_t id ) const { return pool->get(id); }
+
+    uint32_t getSize( uint32_t id ) const { return id == NIL ? 0 : node(id).size; }
+    void     update ( uint32_t id ) { Node &v = node(id); v.size = 1 + getSize(v.left) + getSize(v.right); }
+
+    void retain( uint32_t id ) const
+    {
+        if (id != NIL)
+            node(id).refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release( uint32_t id ) const;
+
+    // Takes a reference to id and returns an exclusive node with the same content: id itself if
+    // the reference was the only one, otherwise a copy that holds its own references to the children
+    uint32_t own( uint32_t id );
+
+    // All of these consume the references they are given and return owned ones
+    uint32_t merge ( uint32_t tl_id, uint32_t tr_id );
+    void     split ( uint32_t t_id, const Key &x, uint32_t &l_id, uint32_t &r_id );   // l_id gets keys < x
+    uint32_t insert( uint32_t t_id, Key &x, Data &val, uint64_t prior );            // x is absent
+    uint32_t assign( uint32_t t_id, const Key &x, Data &val );                      // x is present
+    uint32_t erase ( uint32_t t_id, const Key &x );                                 // x is present
+};
+
+
+template<typename Key, typename Data>
+void persistent_treap<Key, Data>::release(uint32_t id) const
+{
+    while (id != NIL) {
+        Node &v = node(id);
+        if (v.refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        uint32_t left = v.left, right = v.right;
+        pool->destroy(id);
+        release(left);
+        id = right;
+    }
+}
+
+template<typename Key, typename Data>
+uint32_t persistent_treap<Key, Data>::own(uint32_t id)
+{
+    Node &v = node(id);
+    if (v.refs.load(std::memory_order_acquire) == 1)
+        return id;
+    uint32_t copy = pool->create(v.x, v.val, v.prior, v.left, v.right, v.size);
+    retain(v.left);
+    retain(v.right);
+    release(id);
+    return copy;
+}
+
+template<typename Key, typename Data>
+uint32_t persistent_treap<Key, Data>::merge(uint32_t tl_id, uint32_t tr_id)
+{
+    if (tl_id == NIL)
+        return tr_id;
+    if (tr_id == NIL)
+        return tl_id;
+
+    if (node(tl_id).prior < node(tr_id).prior) {
+        tl_id = own(tl_id);
+        Node &tl = node(tl_id);
+        tl.right = merge(tl.right, tr_id);
+        update(tl_id);
+        return tl_id;
+    } else {
+        tr_id = own(tr_id);
+        Node &tr = node(tr_id);
+        tr.left = merge(tl_id, tr.left);
+        update(tr_id);
+        return tr_id;
+    }
+}
+
+template<typename Key, typename Data>
+void persistent_treap<Key, Data>::split(uint32_t t_id, const Key &x, uint32_t &l_id, uint32_t &r_id)
+{
+    if (t_id == NIL) {
+        l_id = r_id = NIL;
+        return;
+    }
+    t_id = own(t_id);
+    Node &t = node(t_id);
+    if (t.x < x) {
+        split(t.right, x, t.right, r_id);
+        l_id = t_id;
+    } else {
+        split(t.left, x, l_id, t.left);
+        r_id = t_id;
+    }
+    update(t_id);
+}
+
+template<typename Key, typename Data>
+uint32_t persistent_treap<Key, Data>::insert(uint32_t t_id, Key &x, Data &val, uint64_t prior)
+{
+    if (t_id == NIL || prior < node(t_id).prior) {
+        uint32_t l_id, r_id;
+        split(t_id, x, l_id, r_id);
+        uint32_t id = pool->create(std::move(x), std::move(val), prior, l_id, r_id);
+        update(id);
+        return id;
+    }
+    t_id = own(t_id);
+    Node &t = node(t_id);
+    if (x < t.x)
+        t.left = insert(t.left, x, val, prior);
+    else
+        t.right = insert(t.right, x, val, prior);
+    ++t.size;
+    return t_id;
+}
+
+template<typename Key, typename Data>
+uint32_t persistent_treap<Key, Data>::assign(uint32_t t_id, const Key &x, Data &val)
+{
+    t_id = own(t_id);
+    Node &t = node(t_id);
+    if (x < t.x)
+        t.left = assign(t.left, x, val);
+    else if (t.x < x)
+        t.right = assign(t.right, x, val);
+    else
+        t.val = std::move(val);
+    return t_id;
+}
+
+template<typename Key, typename Data>
+uint32_t persistent_treap<Key, Data>::erase(uint32_t t_id, const Key &x)
+{
+    Node &v = node(t_id);
+    if (!(x < v.x) && !(v.x < x)) {
+        uint32_t left = v.left, right = v.right;
+        retain(left);
+        retain(right);
+        release(t_id);
+        return merge(left, right);
+    }
+    t_id = own(t_id);
+    Node &t = node(t_id);
+    if (x < t.x)
+        t.left = erase(t.left, x);
+    else
+        t.right = erase(t.right, x);
+    --t.size;
+    return t_id;
+}
+
+template<typename Key, typename Data>
+void persistent_treap<Key, Data>::insert(Key x, Data val)
+{
+    if (contains(x))
+        root_id = assign(root_id, x, val);
+    else
+        root_id = insert(root_id, x, val, detail::wyrand(seed));
+}
+
+template<typename Key, typename Data>
+bool persistent_treap<Key, Data>::erase(const Key &x)
+{
+    if (!contains(x))
+        return false;
+    root_id = erase(root_id, x);
+    return true;
+}
+
+template<typename Key, typename Data>
+const Data* persistent_treap<Key, Data>::find(const Key &x) const
+{
+    uint32_t id = root_id;
+    while (id != NIL) {
+        const Node &v = node(id);
+        if (x < v.x)
+            id = v.left;
+        else if (v.x < x)
+            id = v.right;
+        else
+            return &v.val;
+    }
+    return nullptr;
+}
+
+} // namespace g
+#endif
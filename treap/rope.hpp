@@ -0,0 +1,423 @@
+#ifndef ROPE_HPP
+#define ROPE_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "treap.hpp"
+
+namespace g {
+
+//==================================
+// Rope (implicit-key treap)
+//
+// A sequence stored as a treap ordered by position: a node's index is the size of everything to its
+// left, so no keys are kept and positional insert, erase, split and concat are O(log n) expected.
+// Range reversal is lazy, a flag on the subtree root that is pushed down when split or merge
+// walks through it; readers only track the flag's parity and never modify the tree.
+//
+// split_at and splice move nodes between ropes without copying, so a rope and everything split from
+// it share one node pool; ropes sharing a pool must stay on one thread. Ropes with different pools
+// (e.g. independently constructed) can still be spliced, the nodes are then copied in O(m).
+
+template<typename T>
+class rope
+{
+private:
+    struct Node
+    {
+        T val = T();
+        uint64_t prior;
+        size_t left, right;
+        size_t size;
+        bool rev;
+
+        Node()                 : prior(0), left(-1), right(-1), size(1), rev(false) {}
+        Node(T val, uint64_t prior) : val(std::move(val)), prior(prior), left(-1), right(-1), size(1), rev(false) {}
+    };
+
+    using pool_t = ObjPool<Node>;
+
+    size_t root_id;
+    std::shared_ptr<pool_t> pool;
+    uint64_t seed;
+
+    explicit rope( std::shared_ptr<pool_t> pool ) : root_id(-1), pool(std::move(pool)), seed(detail::treap_seed()) {}
+
+public:
+    template<bool Const>
+    struct basic_iterator
+    {
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = T;
+        using pointer           = std::conditional_t<Const, const T*, T*>;
+        using reference         = std::conditional_t<Const, const T&, T&>;
+
+        basic_iterator() : this_(nullptr) {}
+        basic_iterator( size_t root, const rope *this_ ) : this_(this_) { descend(root, false); }
+        basic_iterator( const basic_iterator<false> &other ) : stack(other.stack), this_(other.this_) {}
+
+        bool operator==( const basic_iterator &other ) const
+        {
+            if (stack.empty() || other.stack.empty())
+                return stack.empty() == other.stack.empty();
+            return stack.back().first == other.stack.back().first;
+        }
+        bool operator!=( const basic_iterator &other ) const { return !((*this) == other); }
+
+        reference operator*()  const { return this_->pool->get(stack.back().first)->val; }
+        pointer   operator->() const { return &this_->pool->get(stack.back().first)->val; }
+
+        basic_iterator& operator++()
+        {
+            assert(!stack.empty());
+            auto [id, flip] = stack.back();
+            stack.pop_back();
+            Node *v = this_->pool->get(id);
+            descend(flip ? v->left : v->right, flip);
+            return (*this);
+        }
+
+        basic_iterator operator++(int)
+        {
+            basic_iterator result(*this);
+            ++(*this);
+            return result;
+        }
+
+    private:
+        friend struct basic_iterator<true>;
+
+        // (node, parity of reversals above and at it); the top is the current node
+        std::vector<std::pair<size_t, bool>> stack;
+        const rope* this_;
+
+        void descend( size_t id, bool flip )
+        {
+            while (id != -1) {
+                Node *v = this_->pool->get(id);
+                flip ^= v->rev;
+                stack.emplace_back(id, flip);
+                id = flip ? v->right : v->left;
+            }
+        }
+    };
+
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    iterator       begin()       { return iterator(root_id, this); }
+    iterator       end()         { return iterator(); }
+    const_iterator begin() const { return const_iterator(root_id, this); }
+    const_iterator end()   const { return const_iterator(); }
+
+
+    //======================================
+    // ROPE interface functions
+
+    rope() : root_id(-1), pool(std::make_shared<pool_t>()), seed(detail::treap_seed()) {}
+    rope( size_t n, const T &val ) : rope() { for (size_t i = 0; i < n; ++i) push_back(val); }
+    rope( std::initializer_list<T> list ) : rope(list.begin(), list.end()) {}
+
+    template<typename ForwardIt, typename = std::enable_if_t<!std::is_integral_v<ForwardIt>>>
+    rope( ForwardIt first, ForwardIt last ) : rope() { root_id = build(first, last); }
+
+    rope( const rope &other ) : rope(other.begin(), other.end()) {}
+    rope( rope &&other ) : root_id(std::exchange(other.root_id, -1)), pool(other.pool), seed(detail::treap_seed()) {}
+    ~rope() { if (pool.use_count() > 1) free_subtree(root_id); }
+
+    rope& operator=( const rope &other )
+    {
+        if (this != &other) {
+            clear();
+            root_id = build(other.begin(), other.end());
+        }
+        return (*this);
+    }
+
+    rope& operator=( rope &&other )
+    {
+        if (this != &other) {
+            clear();
+            pool = other.pool;
+            root_id = std::exchange(other.root_id, -1);
+        }
+        return (*this);
+    }
+
+    size_t size()  const { return getSize(root_id); }
+    bool   empty() const { return root_id == -1; }
+
+    T&       operator[]( size_t n )       { return pool->get(kth(n))->val; }
+    const T& operator[]( size_t n ) const { return pool->get(kth(n))->val; }
+
+    T&       front()       { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T&       back()        { return (*this)[size() - 1]; }
+    const T& back()  const { return (*this)[size() - 1]; }
+
+    void insert_at( size_t pos, T val );
+    void push_back ( T val ) { root_id = merge(root_id, new_node(std::move(val))); }
+    void push_front( T val ) { root_id = merge(new_node(std::move(val)), root_id); }
+
+    void erase_at( size_t pos ) { erase(pos, pos + 1); }
+    void erase   ( size_t first, size_t last );                 // [first, last)
+
+    // Leaves [0, pos) here and returns [pos, size()), sharing this rope's pool
+    rope split_at( size_t pos );
+
+    // Inserts all of other before pos and leaves it empty
+    void splice( size_t pos, rope &other );
+    void splice( size_t pos, rope &&other ) { splice(pos, other); }
+    void concat( rope &other )              { splice(size(), other); }
+    void concat( rope &&other )             { splice(size(), other); }
+
+    void reverse( size_t first, size_t last );                  // [first, last)
+    void reverse() { if (root_id != -1) pool->get(root_id)->rev ^= true; }
+
+    void clear();
+
+private:
+    size_t getSize( size_t id ) const { return id == -1 ? 0 : pool->get(id)->size; }
+
+    size_t new_node( T val );
+    size_t kth( size_t n ) const;
+
+    template<typename ForwardIt>
+    size_t build( ForwardIt first, ForwardIt last );
+
+    void push  ( size_t id );
+    void update( size_t id );
+    void free_subtree( size_t id );
+
+    // Recursive: a lazy reversal has to be pushed on the way down, and the depth is O(log n) expected
+    size_t merge( size_t tl_id, size_t tr_id );
+    void   split( size_t t_id, size_t k, size_t &l_id, size_t &r_id );      // l_id gets the first k
+};
+
+
+template<typename T>
+size_t rope<T>::new_node(T val)
+{
+    size_t id = pool->alloc();
+    *pool->get(id) = Node(std::move(val), detail::wyrand(seed));
+    return id;
+}
+
+template<typename T>
+size_t rope<T>::kth(size_t n) const
+{
+    assert(n < size());
+    size_t id = root_id;
+    bool flip = false;
+    while (true) {
+        Node *v = pool->get(id);
+        flip ^= v->rev;
+        size_t first = flip ? v->right : v->left;
+        size_t i = getSize(first);
+        if (n == i)
+            return id;
+        if (n < i)
+            id = first;
+        else {
+            n -= i + 1;
+            id = flip ? v->left : v->right;
+        }
+    }
+}
+
+template<typename T>
+template<typename ForwardIt>
+size_t rope<T>::build(ForwardIt first, ForwardIt last)
+{
+    // Cartesian tree over the priorities; a node's size is final once it leaves the right spine
+    std::vector<size_t> spine;
+    for (; first != last; ++first) {
+        size_t id = new_node(*first);
+        uint64_t prior = pool->get(id)->prior;
+        size_t last_popped = -1;
+        while (!spine.empty() && pool->get(spine.back())->prior < prior) {
+            last_popped = spine.back();
+            spine.pop_back();
+            update(last_popped);
+        }
+        pool->get(id)->left = last_popped;
+        if (!spine.empty())
+            pool->get(spine.back())->right = id;
+        spine.push_back(id);
+    }
+    while (!spine.empty()) {
+        update(spine.back());
+        if (spine.size() == 1)
+            return spine.back();
+        spine.pop_back();
+    }
+    return -1;
+}
+
+template<typename T>
+void rope<T>::push(size_t id)
+{
+    Node *v = pool->get(id);
+    if (!v->rev)
+        return;
+    std::swap(v->left, v->right);
+    if (v->left != -1)
+        pool->get(v->left)->rev ^= true;
+    if (v->right != -1)
+        pool->get(v->right)->rev ^= true;
+    v->rev = false;
+}
+
+template<typename T>
+void rope<T>::update(size_t id)
+{
+    Node *v = pool->get(id);
+    v->size = 1 + getSize(v->left) + getSize(v->right);
+}
+
+template<typename T>
+void rope<T>::free_subtree(size_t id)
+{
+    std::vector<size_t> stack;
+    if (id != -1)
+        stack.push_back(id);
+    while (!stack.empty()) {
+        id = stack.back();
+        stack.pop_back();
+        Node *v = pool->get(id);
+        if (v->left != -1)
+            stack.push_back(v->left);
+        if (v->right != -1)
+            stack.push_back(v->right);
+        v->val = T();                               // drop the payload now rather than on reuse
+        pool->free(id);
+    }
+}
+
+template<typename T>
+size_t rope<T>::merge(size_t tl_id, size_t tr_id)
+{
+    if (tl_id == -1)
+        return tr_id;
+    if (tr_id == -1)
+        return tl_id;
+
+    if (pool->get(tl_id)->prior > pool->get(tr_id)->prior) {
+        push(tl_id);
+        Node *tl = pool->get(tl_id);
+        tl->right = merge(tl->right, tr_id);
+        update(tl_id);
+        return tl_id;
+    } else {
+        push(tr_id);
+        Node *tr = pool->get(tr_id);
+        tr->left = merge(tl_id, tr->left);
+        update(tr_id);
+        return tr_id;
+    }
+}
+
+template<typename T>
+void rope<T>::split(size_t t_id, size_t k, size_t &l_id, size_t &r_id)
+{
+    if (t_id == -1) {
+        l_id = r_id = -1;
+        return;
+    }
+    push(t_id);
+    Node *t = pool->get(t_id);
+    size_t i = getSize(t->left);
+    if (k <= i) {
+        split(t->left, k, l_id, t->left);
+        r_id = t_id;
+    } else {
+        split(t->right, k - i - 1, t->right, r_id);
+        l_id = t_id;
+    }
+    update(t_id);
+}
+
+template<typename T>
+void rope<T>::insert_at(size_t pos, T val)
+{
+    assert(pos <= size());
+    size_t l_id, r_id;
+    split(root_id, pos, l_id, r_id);
+    root_id = merge(merge(l_id, new_node(std::move(val))), r_id);
+}
+
+template<typename T>
+void rope<T>::erase(size_t first, size_t last)
+{
+    assert(first <= last && last <= size());
+    if (first == last)
+        return;
+    size_t l_id, m_id, r_id;
+    split(root_id, last, m_id, r_id);
+    split(m_id, first, l_id, m_id);
+    free_subtree(m_id);
+    root_id = merge(l_id, r_id);
+}
+
+template<typename T>
+rope<T> rope<T>::split_at(size_t pos)
+{
+    assert(pos <= size());
+    rope result(pool);
+    split(root_id, pos, root_id, result.root_id);
+    return result;
+}
+
+template<typename T>
+void rope<T>::splice(size_t pos, rope &other)
+{
+    assert(pos <= size());
+    if (this == &other || other.root_id == -1)
+        return;
+    size_t m_id;
+    if (pool == other.pool)
+        m_id = std::exchange(other.root_id, -1);
+    else {
+        m_id = build(other.begin(), other.end());
+        other.clear();
+    }
+    size_t l_id, r_id;
+    split(root_id, pos, l_id, r_id);
+    root_id = merge(merge(l_id, m_id), r_id);
+}
+
+template<typename T>
+void rope<T>::reverse(size_t first, size_t last)
+{
+    assert(first <= last && last <= size());
+    if (last - first < 2)
+        return;
+    size_t l_id, m_id, r_id;
+    split(root_id, last, m_id, r_id);
+    split(m_id, first, l_id, m_id);
+    pool->get(m_id)->rev ^= true;
+    root_id = merge(merge(l_id, m_id), r_id);
+}
+
+template<typename T>
+void rope<T>::clear()
+{
+    // The only owner of the pool just starts a fresh one
+    if (pool.use_count() > 1)
+        free_subtree(root_id);
+    else
+        *pool = pool_t();
+    root_id = -1;
+}
+
+} // namespace g
+#endif
@@ -0,0 +1,82 @@
+#include "treap.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+
+std::mt19937 rnd(179);
+
+TEST(Frozen, MatchesTreap)
+{
+    for (size_t n : {0, 1, 2, 3, 7, 8, 9, 100, 1000, 4097}) {
+        g::treap<int, int> T;
+        std::map<int, int> M;
+        while (M.size() < n) {
+            int a = rnd() % (4 * n + 1);
+            M[a] = -a;
+        }
+        T.build_sorted(M.begin(), M.end());
+        g::frozen_map<int, int> F = T.freeze();
+        ASSERT_EQ(F.size(), n);
+
+        auto iter = F.begin();
+        for (auto [x, val] : M) {
+            ASSERT_NE(iter, F.end());
+            EXPECT_EQ((*iter).first, x);
+            EXPECT_EQ((*iter).second, val);
+            ++iter;
+        }
+        EXPECT_EQ(iter, F.end());
+
+        for (int i = 0; i < 500; ++i) {
+            int a = int(rnd() % (4 * n + 3)) - 1;
+            auto it = M.find(a);
+            const int *val = F.find(a);
+            EXPECT_EQ(val != nullptr, it != M.end());
+            if (val) {
+                EXPECT_EQ(*val, it->second);
+            }
+            EXPECT_EQ(F.contains(a), it != M.end());
+
+            auto lb = M.lower_bound(a);
+            auto f_lb = F.lower_bound(a);
+            if (lb == M.end()) {
+                EXPECT_EQ(f_lb, F.end());
+            } else {
+                ASSERT_NE(f_lb, F.end());
+                EXPECT_EQ((*f_lb).first, lb->first);
+            }
+
+            auto ub = M.upper_bound(a);
+            auto f_ub = F.upper_bound(a);
+            if (ub == M.end()) {
+                EXPECT_EQ(f_ub, F.end());
+            } else {
+                ASSERT_NE(f_ub, F.end());
+                EXPECT_EQ((*f_ub).first, ub->first);
+            }
+        }
+    }
+}
+
+TEST(Frozen, Move)
+{
+    std::vector<std::pair<int, int>> V;
+    for (int i = 0; i < 100; ++i)
+        V.emplace_back(2 * i, i);
+    g::frozen_map<int, int> F(V.begin(), V.end());
+    g::frozen_map<int, int> G(std::move(F));
+    EXPECT_EQ(F.size(), 0);
+    EXPECT_EQ(F.find(4), nullptr);
+    EXPECT_EQ(*G.find(4), 2);
+    F = std::move(G);
+    EXPECT_EQ(*F.find(198), 99);
+    EXPECT_EQ(F.find(5), nullptr);
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
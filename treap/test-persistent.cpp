@@ -0,0 +1,147 @@
+#include "persistent_treap.hpp"
+#include <atomic>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+std::mt19937 rnd(179);
+
+// Counts live values, so that leaked or doubly destroyed nodes show up
+struct Tracked
+{
+    static std::atomic<long> alive;
+    int x;
+
+    Tracked( int x = 0 ) : x(x) { ++alive; }
+    Tracked( const Tracked &other ) : x(other.x) { ++alive; }
+    Tracked& operator=( const Tracked &other ) = default;
+    ~Tracked() { --alive; }
+
+    bool operator==( const Tracked &other ) const { return x == other.x; }
+};
+std::atomic<long> Tracked::alive = 0;
+
+using ptreap = g::persistent_treap<int, Tracked>;
+
+static void expect_equal(const ptreap &T, const std::map<int, int> &M)
+{
+    ASSERT_EQ(T.size(), M.size());
+    auto iter = T.begin();
+    for (auto [x, val] : M) {
+        ASSERT_NE(iter, T.end());
+        EXPECT_EQ((*iter).first, x);
+        EXPECT_EQ((*iter).second.x, val);
+        ++iter;
+    }
+    EXPECT_EQ(iter, T.end());
+}
+
+TEST(Persistent, Random)
+{
+    {
+        ptreap T;
+        std::map<int, int> M;
+        std::vector<std::pair<ptreap, std::map<int, int>>> versions;
+        for (int i = 0; i < 20000; ++i) {
+            int x = rnd() % 2000;
+            if (rnd() % 3) {
+                int val = rnd();
+                T.insert(x, val);
+                M[x] = val;
+            } else {
+                EXPECT_EQ(T.erase(x), M.erase(x) == 1);
+            }
+            if (rnd() % 1000 == 0)
+                versions.emplace_back(T.snapshot(), M);
+            if (rnd() % 2000 == 0 && !versions.empty())
+                versions.erase(versions.begin() + rnd() % versions.size());
+        }
+        expect_equal(T, M);
+        for (auto &[V, VM] : versions)
+            expect_equal(V, VM);
+
+        for (int x = 0; x < 2000; ++x) {
+            auto it = M.find(x);
+            const Tracked *val = T.find(x);
+            EXPECT_EQ(val != nullptr, it != M.end());
+            if (val) {
+                EXPECT_EQ(val->x, it->second);
+            }
+        }
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(Persistent, CopyAssign)
+{
+    {
+        ptreap A;
+        for (int i = 0; i < 100; ++i)
+            A.insert(i, i);
+        ptreap B = A, C;
+        C = A;
+        B.erase(5);
+        C.insert(5, 179);
+        EXPECT_EQ(A.find(5)->x, 5);
+        EXPECT_FALSE(B.contains(5));
+        EXPECT_EQ(C.find(5)->x, 179);
+
+        ptreap D(std::move(C));
+        EXPECT_TRUE(C.empty());
+        EXPECT_EQ(D.find(5)->x, 179);
+        A = std::move(D);
+        EXPECT_EQ(A.find(5)->x, 179);
+        A = A;
+        EXPECT_EQ(A.size(), 100);
+        B.clear();
+        EXPECT_TRUE(B.empty());
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(Persistent, ConcurrentReaders)
+{
+    {
+        ptreap T;
+        std::map<int, int> M;
+        for (int i = 0; i < 1000; ++i) {
+            T.insert(i, i);
+            M[i] = i;
+        }
+
+        std::atomic<int> errors = 0;
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; ++r) {
+            readers.emplace_back([snap = T.snapshot(), M, &errors]() mutable {
+                for (int pass = 0; pass < 20; ++pass) {
+                    size_t count = 0;
+                    for (auto [x, val] : snap)
+                        if (M[x] != val.x || ++count > M.size())
+                            ++errors;
+                    if (count != M.size())
+                        ++errors;
+                }
+                snap.clear();                   // drops the version on this thread
+            });
+        }
+        for (int i = 0; i < 20000; ++i) {
+            int x = rnd() % 2000;
+            if (rnd() % 2)
+                T.insert(x, -x);
+            else
+                T.erase(x);
+        }
+        for (auto &t : readers)
+            t.join();
+        EXPECT_EQ(errors, 0);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,134 @@
+#include "rope.hpp"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+std::mt19937 rnd(179);
+
+template<typename T>
+static void expect_equal(const g::rope<T> &R, const std::vector<T> &V)
+{
+    ASSERT_EQ(R.size(), V.size());
+    EXPECT_EQ(std::vector<T>(R.begin(), R.end()), V);
+    for (size_t i = 0; i < V.size(); i += 1 + rnd() % 8)
+        EXPECT_EQ(R[i], V[i]);
+}
+
+TEST(Rope, Construct)
+{
+    g::rope<int> A, B(5, 7), C = {1, 2, 3};
+    expect_equal(A, {});
+    expect_equal(B, {7, 7, 7, 7, 7});
+    expect_equal(C, {1, 2, 3});
+
+    std::vector<int> V(1000);
+    for (auto &x : V)
+        x = rnd();
+    g::rope<int> D(V.begin(), V.end());
+    expect_equal(D, V);
+
+    g::rope<int> E(D);
+    D[0] = 179;
+    EXPECT_EQ(E[0], V[0]);
+    E = D;
+    V[0] = 179;
+    expect_equal(E, V);
+
+    g::rope<int> F(std::move(E));
+    expect_equal(F, V);
+    EXPECT_TRUE(E.empty());
+}
+
+TEST(Rope, Random)
+{
+    g::rope<int> R;
+    std::vector<int> V;
+    for (int i = 0; i < 20000; ++i) {
+        int op = rnd() % 10;
+        size_t a = rnd() % (V.size() + 1), b = rnd() % (V.size() + 1);
+        if (a > b)
+            std::swap(a, b);
+        if (op < 4) {
+            int x = rnd();
+            R.insert_at(a, x);
+            V.insert(V.begin() + a, x);
+        } else if (op < 6 && a < V.size()) {
+            R.erase_at(a);
+            V.erase(V.begin() + a);
+        } else if (op < 7 && b - a < 10) {
+            R.erase(a, b);
+            V.erase(V.begin() + a, V.begin() + b);
+        } else if (op < 9) {
+            R.reverse(a, b);
+            std::reverse(V.begin() + a, V.begin() + b);
+        } else if (!V.empty()) {
+            size_t i = rnd() % V.size();
+            ASSERT_EQ(R[i], V[i]);
+            R[i] = i;
+            V[i] = i;
+        }
+    }
+    expect_equal(R, V);
+    R.reverse();
+    std::reverse(V.begin(), V.end());
+    expect_equal(R, V);
+}
+
+TEST(Rope, SplitSplice)
+{
+    g::rope<std::string> R;
+    std::vector<std::string> V;
+    for (int i = 0; i < 500; ++i) {
+        R.push_back(std::to_string(i));
+        V.push_back(std::to_string(i));
+    }
+    R.push_front("front");
+    V.insert(V.begin(), "front");
+
+    for (int i = 0; i < 500; ++i) {
+        size_t a = rnd() % (V.size() + 1);
+        g::rope<std::string> tail = R.split_at(a);
+        expect_equal(tail, std::vector<std::string>(V.begin() + a, V.end()));
+        ASSERT_EQ(R.size(), a);
+
+        std::vector<std::string> T(V.begin() + a, V.end());
+        V.resize(a);
+        if (rnd() % 2) {
+            tail.reverse();
+            std::reverse(T.begin(), T.end());
+        } else {
+            tail.reverse(0, tail.size() / 2);
+            std::reverse(T.begin(), T.begin() + T.size() / 2);
+        }
+
+        size_t b = rnd() % (V.size() + 1);
+        R.splice(b, tail);
+        V.insert(V.begin() + b, T.begin(), T.end());
+        EXPECT_TRUE(tail.empty());
+    }
+    expect_equal(R, V);
+
+    // Ropes with separate pools are spliced by copying
+    g::rope<std::string> other = {"a", "b", "c"};
+    R.concat(other);
+    V.insert(V.end(), {"a", "b", "c"});
+    expect_equal(R, V);
+    EXPECT_TRUE(other.empty());
+    other.push_back("d");
+    expect_equal(other, {"d"});
+
+    EXPECT_EQ(R.front(), V.front());
+    EXPECT_EQ(R.back(), V.back());
+    R.clear();
+    EXPECT_TRUE(R.empty());
+    R.push_back("x");
+    expect_equal(R, {"x"});
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
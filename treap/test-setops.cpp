@@ -0,0 +1,133 @@
+#include "treap_setops.hpp"
+#include <map>
+#include <random>
+#include "gtest/gtest.h"
+
+std::mt19937 rnd(179);
+
+static std::map<int, int> random_map(size_t n, int range)
+{
+    std::map<int, int> M;
+    while (M.size() < n)
+        M.emplace(rnd() % range, rnd());
+    return M;
+}
+
+static g::treap<int, int> to_treap(const std::map<int, int> &M)
+{
+    g::treap<int, int> T;
+    T.build_sorted(M.begin(), M.end());
+    return T;
+}
+
+static void expect_equal(const g::treap<int, int> &T, const std::map<int, int> &M)
+{
+    ASSERT_EQ(T.size(), M.size());
+    auto iter = T.begin();
+    size_t i = 0;
+    for (auto [x, val] : M){
+        EXPECT_EQ((*iter).first, x);
+        EXPECT_EQ((*iter).second, val);
+        EXPECT_EQ(*T.find(x), val);
+        ++iter;
+        ++i;
+    }
+    EXPECT_EQ(iter, T.end());
+}
+
+static void check_all(size_t n, size_t m, int range, g::thread_pool *pool)
+{
+    auto A = random_map(n, range), B = random_map(m, range);
+    g::treap<int, int> TA = to_treap(A), TB = to_treap(B);
+
+    std::map<int, int> U = A, I, D;
+    for (auto [x, val] : B)
+        U.emplace(x, val);                      // values of the first operand win
+    for (auto [x, val] : A){
+        if (B.count(x))
+            I.emplace(x, val);
+        else
+            D.emplace(x, val);
+    }
+
+    expect_equal(g::treap_union(TA, TB, pool), U);
+    expect_equal(g::treap_intersection(TA, TB, pool), I);
+    expect_equal(g::treap_difference(TA, TB, pool), D);
+
+    // operands are taken by value and stay intact
+    expect_equal(TA, A);
+    expect_equal(TB, B);
+}
+
+TEST(SetOps, Sequential)
+{
+    for (int p = 0; p < 10; ++p)
+        check_all(rnd() % 500, rnd() % 500, 1000, nullptr);
+    check_all(0, 100, 1000, nullptr);
+    check_all(100, 0, 1000, nullptr);
+    check_all(1000, 10, 100000, nullptr);
+    check_all(10, 1000, 100000, nullptr);
+}
+
+TEST(SetOps, Parallel)
+{
+    g::thread_pool pool(4);
+    check_all(20000, 15000, 40000, &pool);
+    check_all(30000, 500, 1000000, &pool);
+    check_all(500, 30000, 1000000, &pool);
+}
+
+TEST(SetOps, ReuseResult)
+{
+    auto A = random_map(300, 1000), B = random_map(300, 1000);
+    g::treap<int, int> T = g::treap_union(to_treap(A), to_treap(B));
+    for (auto [x, val] : B)
+        A.emplace(x, val);
+    for (int i = 0; i < 300; ++i){
+        int a = rnd() % 1000;
+        if (rnd() % 2){
+            T.insert(a, a);
+            A[a] = a;
+        } else {
+            T.erase(a);
+            A.erase(a);
+        }
+    }
+    expect_equal(T, A);
+}
+
+TEST(SetOps, RangeAddPolicy)
+{
+    // Pending tags must survive the copy of the smaller operand
+    using aug_treap = g::treap<int, long long, g::treap_range_add<long long>>;
+    std::vector<std::pair<int, long long>> VA, VB;
+    for (int i = 0; i < 1000; ++i)
+        VA.emplace_back(i, 1);
+    for (int i = 5000; i < 5200; ++i)
+        VB.emplace_back(i, 1);
+    aug_treap A, B;
+    A.build_sorted(VA.begin(), VA.end());
+    B.build_sorted(VB.begin(), VB.end());
+    B.apply(5000, 5200, 10);
+    B.apply(5050, 5100, 100);
+
+    for (auto *pool : {(g::thread_pool*)nullptr, new g::thread_pool(2)}) {
+        aug_treap U = g::treap_union(A, B, pool);
+        long long sum = 0;
+        U.for_each([&sum](const int &, long long &val) { sum += val; });
+        EXPECT_EQ(sum, 8200);
+        EXPECT_EQ(U.query(0, 100000).sum, 8200);
+        EXPECT_EQ(U.query(5040, 5060).sum, 10 * 11 + 10 * 111);
+        EXPECT_EQ(U.query(0, 100000).max, 111);
+
+        aug_treap D = g::treap_difference(B, A, pool);
+        EXPECT_EQ(D.query(0, 100000).sum, 7200);
+        delete pool;
+    }
+}
+
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,4 +1,8 @@
 #include "treap.hpp"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <thread>
 #include <vector>
 #include "gtest/gtest.h"
 
@@ -123,6 +127,332 @@ TEST(Basics, CopyMove)
     }
 }
 
+TEST(Basics, ReinsertAfterErase)
+{
+    g::treap<int, int> T1;
+    std::map<int, int> M;
+    for (int i = 0; i < 5000; ++i){
+        int a = rnd() % 200, b = rnd();
+        if (rnd() % 2){
+            T1.insert(a, b);
+            M[a] = b;
+        } else {
+            T1.erase(a);
+            M.erase(a);
+        }
+    }
+    ASSERT_EQ(T1.size(), M.size());
+    auto iter = T1.begin();
+    for (auto [x, val] : M){
+        EXPECT_EQ((*iter).first, x);
+        EXPECT_EQ((*iter).second, val);
+        ++iter;
+    }
+}
+
+TEST(Basics, TryEmplaceInsertOrAssign)
+{
+    g::treap<int, int> T1;
+    std::map<int, int> M;
+    for (int i = 0; i < 3000; ++i){
+        int a = rnd() % 1000, b = rnd();
+        if (rnd() % 2){
+            auto [iter, inserted] = T1.try_emplace(a, b);
+            auto [m_iter, m_inserted] = M.try_emplace(a, b);
+            EXPECT_EQ(inserted, m_inserted);
+            EXPECT_EQ((*iter).first, a);
+            EXPECT_EQ((*iter).second, m_iter->second);
+            EXPECT_EQ(iter - T1.begin(), std::distance(M.begin(), m_iter));
+        } else {
+            auto [iter, inserted] = T1.insert_or_assign(a, b);
+            auto [m_iter, m_inserted] = M.insert_or_assign(a, b);
+            EXPECT_EQ(inserted, m_inserted);
+            EXPECT_EQ((*iter).second, b);
+            EXPECT_EQ(iter - T1.begin(), std::distance(M.begin(), m_iter));
+        }
+    }
+    ASSERT_EQ(T1.size(), M.size());
+    size_t i = 0;
+    for (auto [x, val] : M){
+        EXPECT_EQ(T1[i], val);
+        EXPECT_EQ(*T1.find(x), val);
+        ++i;
+    }
+}
+
+TEST(Basics, BuildSorted)
+{
+    for (int p = 0; p < 5; ++p){
+        std::vector<std::pair<int, int>> V1;
+        for (int i = 0; i < 500 + rnd() % 1500; ++i)
+            V1.emplace_back(rnd() % 100000, rnd());
+        std::stable_sort(V1.begin(), V1.end(), [](auto a, auto b) { return a.first < b.first; });
+
+        std::map<int, int> M;
+        for (auto [x, val] : V1)
+            M.try_emplace(x, val);              // equal keys keep the first value
+
+        g::treap<int, int> T1;
+        T1.insert(-5, 5);
+        T1.build_sorted(V1.begin(), V1.end());
+        ASSERT_EQ(T1.size(), M.size());
+        size_t i = 0;
+        for (auto [x, val] : M){
+            EXPECT_EQ(T1[i], val);
+            EXPECT_EQ(*T1.find(x), val);
+            EXPECT_EQ((*(T1.begin() + i)).first, x);
+            ++i;
+        }
+        EXPECT_EQ(T1.find(-5), nullptr);
+
+        for (int j = 0; j < 200; ++j){
+            int a = rnd() % 100000;
+            if (rnd() % 2){
+                T1.insert(a, a);
+                M[a] = a;
+            } else {
+                T1.erase(a);
+                M.erase(a);
+            }
+        }
+        ASSERT_EQ(T1.size(), M.size());
+        i = 0;
+        for (auto [x, val] : M)
+            EXPECT_EQ(T1[i++], val);
+    }
+
+    std::vector<int> keys{1, 2, 3, 5, 8, 13};
+    g::treap<int, int> T2;
+    T2.build_sorted(keys.begin(), keys.end());
+    EXPECT_EQ(T2.size(), 6);
+    EXPECT_EQ(*T2.find(8), 0);
+    T2.build_sorted(keys.end(), keys.end());
+    EXPECT_EQ(T2.size(), 0);
+    T2.insert(7, 7);
+    EXPECT_EQ(T2[0], 7);
+}
+
+TEST(Basics, AugmentedRangeAdd)
+{
+    using aug_treap = g::treap<int, long long, g::treap_range_add<long long>>;
+    aug_treap T1;
+    std::map<int, long long> M;
+    std::vector<std::pair<int, long long>> V1;
+    for (int i = 0; i < 300; ++i)
+        V1.emplace_back(i * 3, rnd() % 1000);
+    T1.build_sorted(V1.begin(), V1.end());
+    M.insert(V1.begin(), V1.end());
+
+    for (int j = 0; j < 1500; ++j){
+        int a = rnd() % 1000, b = rnd() % 1000;
+        if (a > b)
+            std::swap(a, b);
+        int op = rnd() % 5;
+        if (op == 0){
+            long long val = rnd() % 1000;
+            T1.insert(a, val);
+            M[a] = val;
+        } else if (op == 1){
+            T1.erase(a);
+            M.erase(a);
+        } else if (op == 2){
+            long long delta = (long long)(rnd() % 200) - 100;
+            T1.apply(a, b, delta);
+            for (auto it = M.lower_bound(a); it != M.end() && it->first < b; ++it)
+                it->second += delta;
+        } else {
+            auto agg = T1.query(a, b);
+            long long sum = 0, mn = std::numeric_limits<long long>::max(), mx = std::numeric_limits<long long>::lowest();
+            for (auto it = M.lower_bound(a); it != M.end() && it->first < b; ++it){
+                sum += it->second;
+                mn = std::min(mn, it->second);
+                mx = std::max(mx, it->second);
+            }
+            EXPECT_EQ(agg.sum, sum);
+            EXPECT_EQ(agg.min, mn);
+            EXPECT_EQ(agg.max, mx);
+        }
+        if (!M.empty()){
+            auto it = std::next(M.begin(), rnd() % M.size());
+            ASSERT_NE(T1.find(it->first), nullptr);
+            EXPECT_EQ(*T1.find(it->first), it->second);
+        }
+    }
+    ASSERT_EQ(T1.size(), M.size());
+    auto iter = T1.begin();
+    for (auto [x, val] : M){
+        EXPECT_EQ((*iter).first, x);
+        EXPECT_EQ((*iter).second, val);
+        ++iter;
+    }
+    EXPECT_EQ(T1.query(0, 1000).sum, T1.query(0, 500).sum + T1.query(500, 1000).sum);
+    EXPECT_EQ(T1.query(5, 5).sum, 0);
+}
+
+TEST(Basics, AugmentedConstReaders)
+{
+    // query, for_each and the searches leave the nodes alone, so they may share a const treap
+    using aug_treap = g::treap<int, long long, g::treap_range_add<long long>>;
+    aug_treap T1;
+    std::map<int, long long> M;
+    std::vector<std::pair<int, long long>> V1;
+    for (int i = 0; i < 2000; ++i)
+        V1.emplace_back(i * 2, i % 7);
+    T1.build_sorted(V1.begin(), V1.end());
+    M.insert(V1.begin(), V1.end());
+    for (int j = 0; j < 50; ++j){
+        int a = rnd() % 4000, b = rnd() % 4000;
+        if (a > b)
+            std::swap(a, b);
+        T1.apply(a, b, j);
+        for (auto it = M.lower_bound(a); it != M.end() && it->first < b; ++it)
+            it->second += j;
+    }
+
+    const aug_treap &C1 = T1;
+    std::vector<std::thread> T;
+    std::vector<int> failures(4, 0);
+    for (int t = 0; t < 4; ++t)
+        T.emplace_back([&C1, &M, &failures, t]() {
+            std::mt19937 gen(t);
+            for (int i = 0; i < 300; ++i){
+                int a = gen() % 4000, b = gen() % 4000;
+                long long sum = 0;
+                for (auto it = M.lower_bound(a); it != M.end() && it->first < b; ++it)
+                    sum += it->second;
+                if (C1.query(a, b).sum != sum)
+                    ++failures[t];
+                long long seen = 0;
+                C1.for_each(a, b, [&seen](const int &, const long long &val) { seen += val; });
+                if (seen != sum)
+                    ++failures[t];
+                if (C1.rank(a) != (size_t)std::distance(M.begin(), M.lower_bound(a)))
+                    ++failures[t];
+            }
+        });
+    for (auto &t : T)
+        t.join();
+    EXPECT_EQ(failures, std::vector<int>(4, 0));
+
+    auto iter = C1.begin();
+    for (auto [x, val] : M){
+        EXPECT_EQ((*iter).first, x);
+        EXPECT_EQ((*iter).second, val);
+        ++iter;
+    }
+}
+
+TEST(Basics, BoundsRankCount)
+{
+    g::treap<int, int> T1;
+    std::vector<int> V1;
+    for (int i = 0; i < 1000; ++i){
+        int a = rnd() % 5000;
+        T1.insert(a, -a);
+        V1.push_back(a);
+    }
+    std::sort(V1.begin(), V1.end());
+    V1.erase(std::unique(V1.begin(), V1.end()), V1.end());
+    ASSERT_EQ(T1.end() - T1.begin(), V1.size());
+
+    for (int i = 0; i < 1000; ++i){
+        int a = rnd() % 5200 - 100, b = rnd() % 5200 - 100;
+        size_t lb = std::lower_bound(V1.begin(), V1.end(), a) - V1.begin();
+        size_t ub = std::upper_bound(V1.begin(), V1.end(), a) - V1.begin();
+
+        auto it = T1.lower_bound(a);
+        EXPECT_EQ(it - T1.begin(), lb);
+        if (lb == V1.size()){
+            EXPECT_EQ(it, T1.end());
+        } else {
+            EXPECT_EQ((*it).first, V1[lb]);
+            EXPECT_EQ((*it).second, -V1[lb]);
+            ++it;
+            EXPECT_EQ(it - T1.begin(), lb + 1);
+        }
+
+        it = T1.upper_bound(a);
+        EXPECT_EQ(it - T1.begin(), ub);
+        if (ub != V1.size()){
+            EXPECT_EQ((*it).first, V1[ub]);
+        }
+
+        EXPECT_EQ(T1.rank(a), lb);
+        size_t cnt = 0;
+        for (int x : V1)
+            cnt += (a <= x && x < b);
+        EXPECT_EQ(T1.count(a, b), cnt);
+    }
+
+    // iterators built from a node id get their position too
+    auto [it, inserted] = T1.try_emplace(V1[V1.size() / 2]);
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(it - T1.begin(), V1.size() / 2);
+    EXPECT_EQ(T1.end() - T1.kth_elem(10), V1.size() - 10);
+
+    g::treap<int, int> T2;
+    EXPECT_EQ(T2.lower_bound(5), T2.end());
+    EXPECT_EQ(T2.rank(5), 0);
+    EXPECT_EQ(T2.count(0, 10), 0);
+}
+
+TEST(Basics, ForEach)
+{
+    g::treap<int, int> T1;
+    std::map<int, int> M;
+    for (int i = 0; i < 1000; ++i){
+        int a = rnd() % 5000;
+        T1.insert(a, i);
+        M[a] = i;
+    }
+
+    std::vector<std::pair<int, int>> V1, V2(M.begin(), M.end());
+    T1.for_each([&](const int &x, int &val) { V1.emplace_back(x, val); });
+    EXPECT_EQ(V1, V2);
+
+    for (int i = 0; i < 200; ++i){
+        int a = rnd() % 5200 - 100, b = rnd() % 5200 - 100;
+        V1.clear();
+        V2.clear();
+        T1.for_each(a, b, [&](const int &x, int &val) { V1.emplace_back(x, val); });
+        for (auto it = M.lower_bound(a); it != M.end() && it->first < b; ++it)
+            V2.emplace_back(*it);
+        EXPECT_EQ(V1, V2);
+    }
+
+    T1.for_each([](const int &, int &val) { val = 179; });
+    EXPECT_EQ(*T1.find(M.begin()->first), 179);
+}
+
+TEST(Basics, IndependentThreads)
+{
+    // Every treap has its own priority stream, so separate treaps can be built concurrently
+    std::vector<std::thread> T;
+    std::vector<int> failures(4, 0);
+    for (int t = 0; t < 4; ++t)
+        T.emplace_back([&failures, t]() {
+            std::mt19937 gen(t);
+            g::treap<int, int> T1;
+            std::vector<int> V1;
+            for (int i = 0; i < 500; ++i){
+                int a = gen();
+                T1.insert(a, a);
+                V1.push_back(a);
+            }
+            std::sort(V1.begin(), V1.end());
+            V1.erase(std::unique(V1.begin(), V1.end()), V1.end());
+            if (T1.size() != V1.size())
+                ++failures[t];
+            size_t i = 0;
+            for (auto iter = T1.begin(); iter != T1.end(); ++iter, ++i)
+                if ((*iter).first != V1[i])
+                    ++failures[t];
+        });
+    for (auto &t : T)
+        t.join();
+    EXPECT_EQ(failures, std::vector<int>(4, 0));
+}
+
 
 int main(int argc, char* argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
@@ -1,7 +1,10 @@
 #ifndef TREAP_HPP
 #define TREAP_HPP
 
+#include <atomic>
 #include <cstdint>
+#include <iterator>
+#include <type_traits>
 #include <cstddef>
 #include <random>
 #include <vector>
@@ -9,10 +12,33 @@
 #include <cassert>
 #include <utility>
 #include <set>
+#include <algorithm>
+#include <limits>
+
+#include "frozen_map.hpp"
 
 namespace g {
 
-static std::mt19937 rnd(179);
+namespace detail {
+
+// Every treap draws priorities from its own wyrand stream; seeds are spread with splitmix64
+inline uint64_t treap_seed()
+{
+    static std::atomic<uint64_t> counter(179);
+    uint64_t z = counter.fetch_add(0x9E3779B97F4A7C15ull, std::memory_order_relaxed);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline uint64_t wyrand(uint64_t &seed)
+{
+    seed += 0xA0761D6478BD642Full;
+    __uint128_t t = (__uint128_t)seed * (seed ^ 0xE7037ED1A0B428DBull);
+    return uint64_t(t >> 64) ^ uint64_t(t);
+}
+
+} // namespace detail
 
 ///==================================
 // Object pool
@@ -147,9 +173,88 @@ private:
 #define TREAP_CHECK(v) {}
 #endif
 
-template<typename Key, typename Data>
+//==================================
+// Treap augmentation
+//
+// A Policy attaches a monoid aggregate to every subtree and a lazy tag that updates the values of
+// a whole subtree at once. It provides
+//     value_type, tag_type
+//     static value_type identity();
+//     static value_type lift   ( const Key &x, const Data &val );
+//     static value_type combine( const value_type &a, const value_type &b );          // a goes first
+//     static void       apply  ( Data &val, const tag_type &tag );
+//     static void       apply  ( value_type &agg, const tag_type &tag, size_t count );
+//     static void       compose( tag_type &tag, const tag_type &newer );              // tag, then newer
+// A tagged node already holds its updated value and aggregate, the tag is still owed to its
+// children. Keys are never touched, so tags can not reorder the tree.
+//
+// Const readers leave the nodes alone: searches and iterator steps only look at keys and sizes,
+// query and for_each carry the tags owed from above down their path and apply them to what they
+// read. find and Iterator::operator* hand out references into a node, so they first push the tags
+// above it down; on an augmented treap they need the same exclusive access as a writer.
+
+namespace detail {
+
+template<typename Policy>
+struct treap_aug
+{
+    using value_type = typename Policy::value_type;
+    using tag_type   = typename Policy::tag_type;
+
+    typename Policy::value_type agg = Policy::identity();
+    typename Policy::tag_type   tag = typename Policy::tag_type();
+    bool tagged = false;
+};
+
+template<>
+struct treap_aug<void>
+{
+    struct none {};
+    using value_type = none;
+    using tag_type   = none;
+};
+
+} // namespace detail
+
+// Sum, minimum and maximum of the values, with "add delta" as the range update
+template<typename T>
+struct treap_range_add
+{
+    struct value_type
+    {
+        T sum, min, max;
+    };
+    using tag_type = T;
+
+    static value_type identity() { return {T(), std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest()}; }
+
+    template<typename Key>
+    static value_type lift( const Key&, const T &val ) { return {val, val, val}; }
+
+    static value_type combine( const value_type &a, const value_type &b )
+    {
+        return {a.sum + b.sum, std::min(a.min, b.min), std::max(a.max, b.max)};
+    }
+
+    static void apply( T &val, const tag_type &delta ) { val += delta; }
+    static void apply( value_type &agg, const tag_type &delta, size_t count )
+    {
+        agg.sum += delta * T(count);
+        agg.min += delta;
+        agg.max += delta;
+    }
+
+    static void compose( tag_type &delta, const tag_type &newer ) { delta += newer; }
+};
+
+template<typename Key, typename Data, typename Policy>
+struct treap_setops;                                // treap_setops.hpp
+
+template<typename Key, typename Data, typename Policy = void>
 class treap
 {
+    friend struct treap_setops<Key, Data, Policy>;
+
 private:
     struct Node
     {
@@ -159,24 +264,31 @@ private:
         size_t parent;
         size_t left, right;
         size_t size;
+        [[no_unique_address]] detail::treap_aug<Policy> aug;
 
-        Node()                : prior(rnd()), parent(-1), left(-1), right(-1), size(1) {}
-        Node(Key x, Data val) : x(x), prior(rnd()), val(val), parent(-1), left(-1), right(-1), size(1) {}
+        Node()                : prior(0), parent(-1), left(-1), right(-1), size(1) {}
+        Node(Key x, Data val) : x(x), prior(0), val(val), parent(-1), left(-1), right(-1), size(1) {}
 
         ~Node() {};
     };
 
     size_t root_id;
     ObjPool<Node> pool;
+    uint64_t seed;
 
 public:
+    using agg_type = typename detail::treap_aug<Policy>::value_type;
+    using tag_type = typename detail::treap_aug<Policy>::tag_type;
+
     struct Iterator
     {
         using iterator_category = std::random_access_iterator_tag;
         using difference_type   = std::ptrdiff_t;
         using value_type        = Node;
 
-        Iterator( size_t id=-1, const treap* this_=nullptr ) : id(id), this_(this_), pos(0) {}     // WARNING: don't use for non-begin iterator, pos will invalidate
+        // pos is the in-order index of id (size() for end), found by climbing parent links unless given
+        Iterator( size_t id=-1, const treap* this_=nullptr ) : pos(this_ ? this_->rank_of(id) : 0), id(id), this_(this_) {}
+        Iterator( size_t id, const treap* this_, size_t pos ) : pos(pos), id(id), this_(this_) {}
         Iterator( const Iterator &other ) = default;
 
         bool operator==( const Iterator other ) const { return id == other.id; }
@@ -190,10 +302,10 @@ public:
         void setPos(size_t pos_) { pos = pos_; }
         void setId (size_t id_ ) { id  = id_;  }
 
-        std::pair<Key, Data&> operator*() { Node* v = this_->pool.get(id); \
+        std::pair<Key, Data&> operator*() { Node* v = this_->settle(id); \
                                             return {v->x, v->val}; }
 
-        const std::pair<const Key, const Data&> operator*() const { Node* v = this_->pool.get(id); \
+        const std::pair<const Key, const Data&> operator*() const { Node* v = this_->settle(id); \
                                             return std::make_pair(v->x, v->val); }
 
 
@@ -329,8 +441,7 @@ public:
     };
 
     Iterator kth_elem(size_t k) const {
-        Iterator result(0, this);
-        result.setPos(k);
+        Iterator result(-1, this, k);
         size_t id = root_id;
         assert(id != -1);
         Node *v;
@@ -353,7 +464,7 @@ public:
 
 
 
-    Iterator begin() const { return Iterator(min_vert(root_id), this); }
+    Iterator begin() const { return Iterator(min_vert(root_id), this, 0); }
     Iterator end()   const { return Iterator(-1, this); }
 
 
@@ -361,8 +472,8 @@ public:
     //======================================
     // TREAP interface functions
 
-    treap() : root_id(-1) {}
-    treap(const treap &other) : root_id(other.root_id), pool(other.pool) {}
+    treap() : root_id(-1), seed(detail::treap_seed()) {}
+    treap(const treap &other) : root_id(other.root_id), pool(other.pool), seed(detail::treap_seed()) {}
     treap(treap &&other);
     ~treap() = default;
 
@@ -381,11 +492,51 @@ public:
     void   insert( Key x, Data val );
     Data*  insert( Key x );
 
+    // Both make a single descent; second is false if x was already present
+    template<typename ...Args>
+    std::pair<Iterator, bool> try_emplace( Key x, Args&&... args );        // leaves an existing value untouched
+    template<typename M>
+    std::pair<Iterator, bool> insert_or_assign( Key x, M &&obj );
+
+    // Replaces the content with [first, last) in O(n); elements are keys or (key, value) pairs in
+    // ascending key order, of equal keys the first one is kept. Nodes take pool slots in key order.
+    template<typename ForwardIt>
+    void   build_sorted( ForwardIt first, ForwardIt last );
+
     void   erase ( Key x ) { if (root_id != -1)  root_id = erase(root_id, x); }
     size_t erase ( size_t id, Key x );
 
     Data* find( Key x ) const;
 
+    // Single descents, iterators come with their pos; rank is the number of keys less than x
+    Iterator lower_bound( const Key &x ) const { return bound(x, false); }
+    Iterator upper_bound( const Key &x ) const { return bound(x, true);  }
+    size_t   rank ( const Key &x ) const { return bound(x, false) - begin(); }
+    size_t   count( const Key &lo, const Key &hi ) const        // keys in [lo, hi)
+    {
+        if (!(lo < hi))
+            return 0;
+        return bound(hi, false) - bound(lo, false);
+    }
+
+    // In-order walks with an explicit stack: every node is loaded once and a right child is
+    // prefetched when its parent is stacked, while Iterator::operator++ climbs parent links.
+    // func(const Key&, Data&) is called for every key, or for the keys in [lo, hi). With a Policy
+    // func gets a copy of the value with the pending tags applied, so writes to it are dropped.
+    template<typename FunctionT>
+    void for_each( FunctionT func ) const { scan(root_id, nullptr, nullptr, func); }
+    template<typename FunctionT>
+    void for_each( const Key &lo, const Key &hi, FunctionT func ) const { scan(root_id, &lo, &hi, func); }
+
+    // Read-only copy laid out for searching, see frozen_map.hpp; O(n)
+    frozen_map<Key, Data> freeze() const;
+
+    // Need a Policy. query combines the values with keys in [lo, hi) without changing the tree,
+    // apply tags them via split and merge; both are O(log n). Values written through find() or
+    // iterators bypass the aggregates, insert and insert_or_assign keep them up to date.
+    agg_type query( const Key &lo, const Key &hi ) const;
+    void     apply( const Key &lo, const Key &hi, const tag_type &tag );
+
     #ifndef NDEBUG
     void print      ( std::ostream &out ) const { print(out, root_id); out << '\n'; }
     void print_graph( std::ostream &out ) const
@@ -418,10 +569,47 @@ private:
     void print_graph( std::ostream &out, size_t id ) const;
     void print( std::ostream &out, size_t id ) const;
 
+    // Top-down and iterative; sizes are fixed afterwards by climbing parent links from the deepest
+    // touched node. Define TREAP_RECURSIVE_SPLIT_MERGE to use the recursive versions instead.
     size_t                    merge( size_t tl_id, size_t tr_id );
-    std::pair<size_t, size_t> split( size_t t_id, Key k );
+    std::pair<size_t, size_t> split( size_t t_id, Key k, bool strict = false );     // strict leaves k itself right
+
+    size_t                    merge_recursive( size_t tl_id, size_t tr_id );
+    std::pair<size_t, size_t> split_recursive( size_t t_id, Key k, bool strict = false );
+
+    void update_path( size_t id );                  // update() from id up to its root
 
     void update( size_t id );
+
+    // Hands a pending tag down to the children and returns the node. Writers push on their way
+    // down; of the const members only find and settle do, as they hand out references to values.
+    Node* push   ( size_t id ) const;
+    Node* settle ( size_t id ) const;               // pushes the tags above id down to it
+
+    // Tags owed to a node by its ancestors, composed oldest first; readers carry it down their path
+    struct pending_tag
+    {
+        tag_type tag = tag_type();
+        bool tagged = false;
+    };
+    pending_tag below   ( const Node *v, const pending_tag &owed ) const;     // owed to v's children
+    Data        value_of( const Node *v, const pending_tag &owed ) const;
+    agg_type    agg_of  ( size_t id, const pending_tag &owed ) const;
+
+    template<typename FunctionT>
+    void scan( size_t id, const Key *lo, const Key *hi, FunctionT &func ) const;
+
+    Iterator bound  ( const Key &x, bool upper ) const;     // first key not less than x, or greater
+    size_t   rank_of( size_t id ) const;                    // in-order index of a node, size() for -1
+    void  add_tag( size_t id, const tag_type &tag ) const;
+    agg_type getAgg( size_t id ) const { if (id == -1) return Policy::identity(); return pool.get(id)->aug.agg; }
+    size_t new_node( Key x, Data val = Data() ) { return new_node(x, std::move(val), detail::wyrand(seed)); }
+    size_t new_node( Key x, Data val, size_t prior );
+
+    // Walks down by key, remembering where a node with a fresh priority would sit, and splits only
+    // the subtree below that point. rank receives the number of keys less than x.
+    template<typename ...Args>
+    std::pair<size_t, bool> emplace_unique( const Key &x, size_t &rank, Args&&... args );
     void insert( Node &node);                       //TODO write it to emplement faster 0 nodes removal
 
     size_t getSize( size_t v_id ) const { if (v_id == -1) return 0; return pool.get(v_id)->size; }
@@ -431,24 +619,24 @@ private:
 };
 
 
-template<typename Key, typename Data>
-treap<Key, Data>::treap(treap &&other)
+template<typename Key, typename Data, typename Policy>
+treap<Key, Data, Policy>::treap(treap &&other) : seed(other.seed)
 {
     root_id = std::exchange(other.root_id, -1);
     pool = std::move(other.pool);
 }
 
 
-template<typename Key, typename Data>
-treap<Key, Data>& treap<Key, Data>::operator=(const treap<Key, Data> &other)
+template<typename Key, typename Data, typename Policy>
+treap<Key, Data, Policy>& treap<Key, Data, Policy>::operator=(const treap<Key, Data, Policy> &other)
 {
     root_id = other.root_id;
     pool = other.pool;
     return (*this);
 }
 
-template<typename Key, typename Data>
-treap<Key, Data>& treap<Key, Data>::operator=(treap<Key, Data> &&other)
+template<typename Key, typename Data, typename Policy>
+treap<Key, Data, Policy>& treap<Key, Data, Policy>::operator=(treap<Key, Data, Policy> &&other)
 {
     root_id = std::exchange(other.root_id, -1);
     pool = std::move(other.pool);
@@ -456,8 +644,8 @@ treap<Key, Data>& treap<Key, Data>::operator=(treap<Key, Data> &&other)
 }
 
 
-template<typename Key, typename Data>
-bool treap<Key, Data>::operator==(const treap<Key, Data> &other) const {
+template<typename Key, typename Data, typename Policy>
+bool treap<Key, Data, Policy>::operator==(const treap<Key, Data, Policy> &other) const {
     if (root_id != other.root_id)
         return false;
 
@@ -474,50 +662,181 @@ bool treap<Key, Data>::operator==(const treap<Key, Data> &other) const {
 }
 
 
-template<typename Key, typename Data>
-void treap<Key, Data>::insert(Key x, Data val)
+template<typename Key, typename Data, typename Policy>
+template<typename ...Args>
+std::pair<size_t, bool> treap<Key, Data, Policy>::emplace_unique(const Key &x, size_t &rank, Args&&... args)
 {
-    Data* q = find(x);
-    if (q)
+    size_t prior = detail::wyrand(seed);
+    size_t at = -1, at_parent = -1;                 // the new node takes at's place under at_parent
+    size_t id = root_id, parent = -1;
+    rank = 0;
+    while (id != -1)
     {
-        *q = val;
-        return;
+        Node *v = push(id);
+        if (at == -1 && prior < v->prior)
+        {
+            at = id;
+            at_parent = parent;
+        }
+        if (v->x == x)
+        {
+            rank += getSize(v->left);
+            return {id, false};
+        }
+        parent = id;
+        if (x < v->x)
+            id = v->left;
+        else
+        {
+            rank += getSize(v->left) + 1;
+            id = v->right;
+        }
+    }
+    if (at == -1)
+        at_parent = parent;
+
+    size_t new_id = new_node(x, Data(std::forward<Args>(args)...), prior);
+    auto [tl_id, tr_id] = split(at, x);
+    Node *v = pool.get(new_id);
+    v->left = tl_id;
+    v->right = tr_id;
+    update(new_id);
+
+    v->parent = at_parent;
+    if (at_parent == -1)
+        root_id = new_id;
+    else
+    {
+        Node *p = pool.get(at_parent);
+        (x < p->x ? p->left : p->right) = new_id;
+        if constexpr (std::is_void_v<Policy>)
+            for (size_t up = at_parent; up != -1; up = pool.get(up)->parent)
+                ++pool.get(up)->size;
+        else
+            update_path(at_parent);
     }
-
-    auto [tl_id, tr_id] = split(root_id, x);
-    size_t tm_id = pool.alloc();
-    assert(tm_id != -1);
-    Node *v = pool.get(tm_id);
-    v->val = val;
-    v->x = x;
-    root_id = merge(merge(tl_id, tm_id), tr_id);
     TREAP_CHECK(root_id);
+    return {new_id, true};
 }
 
-template<typename Key, typename Data>
-Data* treap<Key, Data>::insert(Key x)
+template<typename Key, typename Data, typename Policy>
+void treap<Key, Data, Policy>::insert(Key x, Data val)
 {
-    Data* q = find(x);
-    if (q)
-        return q;
+    size_t rank;
+    auto [id, inserted] = emplace_unique(x, rank, val);
+    if (!inserted)
+    {
+        pool.get(id)->val = val;
+        if constexpr (!std::is_void_v<Policy>)
+            update_path(id);
+    }
+}
 
-    auto [tl_id, tr_id] = split(root_id, x);
-    size_t tm_id = pool.alloc();
-    assert(tm_id != -1);
-    Node *v = pool.get(tm_id);
-    v->x = x;
-    root_id = merge(merge(tl_id, tm_id), tr_id);
-    TREAP_CHECK(root_id);
-    return &(v->val);
+template<typename Key, typename Data, typename Policy>
+Data* treap<Key, Data, Policy>::insert(Key x)
+{
+    size_t rank;
+    return &pool.get(emplace_unique(x, rank).first)->val;
 }
 
+template<typename Key, typename Data, typename Policy>
+template<typename ...Args>
+std::pair<typename treap<Key, Data, Policy>::Iterator, bool> treap<Key, Data, Policy>::try_emplace(Key x, Args&&... args)
+{
+    size_t rank;
+    auto [id, inserted] = emplace_unique(x, rank, std::forward<Args>(args)...);
+    Iterator it(id, this, rank);
+    return {it, inserted};
+}
 
-template<typename Key, typename Data>
-size_t treap<Key, Data>::erase(size_t id, Key x) //TODO find bug
+template<typename Key, typename Data, typename Policy>
+template<typename M>
+std::pair<typename treap<Key, Data, Policy>::Iterator, bool> treap<Key, Data, Policy>::insert_or_assign(Key x, M &&obj)
+{
+    size_t rank;
+    auto [id, inserted] = emplace_unique(x, rank, std::forward<M>(obj));   // obj is only consumed on insertion
+    if (!inserted)
+    {
+        pool.get(id)->val = std::forward<M>(obj);
+        if constexpr (!std::is_void_v<Policy>)
+            update_path(id);
+    }
+    Iterator it(id, this, rank);
+    return {it, inserted};
+}
+
+
+template<typename Key, typename Data, typename Policy>
+template<typename ForwardIt>
+void treap<Key, Data, Policy>::build_sorted(ForwardIt first, ForwardIt last)
+{
+    size_t n = std::distance(first, last);
+    pool = ObjPool<Node>(n ? n : 1);
+    root_id = -1;
+
+    // The right spine of the Cartesian tree built so far is chained by parent links from tail up.
+    // A node leaving the spine has its subtree complete, so its size is final at that point.
+    size_t tail = -1;
+    auto finish = [this](size_t id, size_t right_done) {
+        Node *v = pool.get(id);
+        v->size = 1 + getSize(v->left) + getSize(right_done);
+        if constexpr (!std::is_void_v<Policy>)
+            v->aug.agg = Policy::combine(Policy::combine(getAgg(v->left), Policy::lift(v->x, v->val)), getAgg(right_done));
+    };
+
+    for (; first != last; ++first)
+    {
+        Key x;
+        Data val = Data();
+        if constexpr (std::is_convertible_v<decltype(*first), Key>)
+            x = *first;
+        else
+        {
+            x = (*first).first;
+            val = (*first).second;
+        }
+        if (tail != -1 && !(pool.get(tail)->x < x))
+        {
+            assert(!(x < pool.get(tail)->x) && "build_sorted needs ascending keys");
+            continue;
+        }
+
+        size_t id = new_node(x, val);
+        size_t prior = pool.get(id)->prior;
+        size_t popped = -1, cur = tail;
+        while (cur != -1 && prior < pool.get(cur)->prior)
+        {
+            finish(cur, popped);
+            popped = cur;
+            cur = pool.get(cur)->parent;
+        }
+
+        Node *v = pool.get(id);
+        v->left = popped;
+        v->parent = cur;
+        if (popped != -1)
+            pool.get(popped)->parent = id;
+        if (cur == -1)
+            root_id = id;
+        else
+            pool.get(cur)->right = id;
+        tail = id;
+    }
+
+    for (size_t popped = -1; tail != -1; tail = pool.get(tail)->parent)
+    {
+        finish(tail, popped);
+        popped = tail;
+    }
+    TREAP_CHECK(root_id);
+}
+
+template<typename Key, typename Data, typename Policy>
+size_t treap<Key, Data, Policy>::erase(size_t id, Key x) //TODO find bug
 {
     if (id == -1)
         return -1;
-    Node *v = pool.get(id);
+    Node *v = push(id);
     if (v->x == x)
     {
         size_t tl_id = v->left;
@@ -543,12 +862,12 @@ size_t treap<Key, Data>::erase(size_t id, Key x) //TODO find bug
     return id;
 }
 
-template<typename Key, typename Data>
-Data* treap<Key, Data>::find(Key x) const
+template<typename Key, typename Data, typename Policy>
+Data* treap<Key, Data, Policy>::find(Key x) const
 {
     size_t cur_id = root_id;
     Node *v;
-    while (cur_id != -1 && ((v = pool.get(cur_id))->x != x))
+    while (cur_id != -1 && ((v = push(cur_id))->x != x))
     {
         if (v->x > x)
             cur_id = v->left;
@@ -560,8 +879,177 @@ Data* treap<Key, Data>::find(Key x) const
     return nullptr;
 }
 
-template<typename Key, typename Data>
-bool treap<Key, Data>::graph_check(size_t id, std::set<size_t> &S) const
+template<typename Key, typename Data, typename Policy>
+typename treap<Key, Data, Policy>::Iterator treap<Key, Data, Policy>::bound(const Key &x, bool upper) const
+{
+    size_t result = -1, result_rank = size();
+    size_t id = root_id, rank = 0;
+    while (id != -1)
+    {
+        Node *v = pool.get(id);
+        if (upper ? x < v->x : !(v->x < x))
+        {
+            result = id;
+            result_rank = rank + getSize(v->left);
+            id = v->left;
+        }
+        else
+        {
+            rank += getSize(v->left) + 1;
+            id = v->right;
+        }
+    }
+    return Iterator(result, this, result_rank);
+}
+
+template<typename Key, typename Data, typename Policy>
+template<typename FunctionT>
+void treap<Key, Data, Policy>::scan(size_t id, const Key *lo, const Key *hi, FunctionT &func) const
+{
+    constexpr bool augmented = !std::is_void_v<Policy>;
+    std::vector<size_t> stack;
+    std::vector<pending_tag> owed_stack;            // augmented only: the tags owed to each stacked node
+    stack.reserve(64);
+    auto descend = [&](size_t id, pending_tag owed) {
+        while (id != -1)
+        {
+            Node *v = pool.get(id);
+            pending_tag v_owed = owed;
+            if constexpr (augmented)
+                owed = below(v, owed);
+            if (lo && v->x < *lo)                   // the whole left subtree is below lo as well
+            {
+                id = v->right;
+                continue;
+            }
+            if (v->right != -1)
+                __builtin_prefetch(pool.get(v->right));
+            stack.push_back(id);
+            if constexpr (augmented)
+                owed_stack.push_back(v_owed);
+            id = v->left;
+        }
+    };
+
+    descend(id, pending_tag());
+    while (!stack.empty())
+    {
+        Node *v = pool.get(stack.back());
+        stack.pop_back();
+        if (hi && !(v->x < *hi))
+            return;
+        if constexpr (augmented)
+        {
+            pending_tag owed = owed_stack.back();
+            owed_stack.pop_back();
+            Data val = value_of(v, owed);
+            func(static_cast<const Key&>(v->x), val);
+            descend(v->right, below(v, owed));
+        }
+        else
+        {
+            func(static_cast<const Key&>(v->x), v->val);
+            descend(v->right, pending_tag());
+        }
+    }
+}
+
+template<typename Key, typename Data, typename Policy>
+frozen_map<Key, Data> treap<Key, Data, Policy>::freeze() const
+{
+    std::vector<std::pair<Key, Data>> items;
+    items.reserve(size());
+    for_each([&items](const Key &x, Data &val) { items.emplace_back(x, val); });
+    return frozen_map<Key, Data>(items.begin(), items.end());
+}
+
+template<typename Key, typename Data, typename Policy>
+size_t treap<Key, Data, Policy>::rank_of(size_t id) const
+{
+    if (id == -1)
+        return size();
+    size_t rank = getSize(pool.get(id)->left);
+    for (size_t parent; (parent = pool.get(id)->parent) != -1; id = parent)
+    {
+        Node *p = pool.get(parent);
+        if (p->right == id)
+            rank += getSize(p->left) + 1;
+    }
+    return rank;
+}
+
+template<typename Key, typename Data, typename Policy>
+typename treap<Key, Data, Policy>::agg_type treap<Key, Data, Policy>::query(const Key &lo, const Key &hi) const
+{
+    static_assert(!std::is_void_v<Policy>, "query needs an augmentation policy");
+
+    // The first node inside [lo, hi) on the way down splits the range into a suffix of its left
+    // subtree and a prefix of its right one; each is collected along a single path.
+    size_t id = root_id;
+    Node *v = nullptr;
+    pending_tag owed;
+    while (id != -1)
+    {
+        v = pool.get(id);
+        if (v->x < lo)
+            id = v->right;
+        else if (!(v->x < hi))
+            id = v->left;
+        else
+            break;
+        owed = below(v, owed);
+    }
+    if (id == -1)
+        return Policy::identity();
+
+    agg_type left = Policy::identity(), right = Policy::identity();
+    pending_tag l_owed = below(v, owed);
+    for (size_t l_id = v->left; l_id != -1; )
+    {
+        Node *u = pool.get(l_id);
+        pending_tag u_owed = l_owed;
+        l_owed = below(u, u_owed);
+        if (u->x < lo)
+            l_id = u->right;
+        else
+        {
+            left = Policy::combine(Policy::combine(Policy::lift(u->x, value_of(u, u_owed)), agg_of(u->right, l_owed)), left);
+            l_id = u->left;
+        }
+    }
+    pending_tag r_owed = below(v, owed);
+    for (size_t r_id = v->right; r_id != -1; )
+    {
+        Node *u = pool.get(r_id);
+        pending_tag u_owed = r_owed;
+        r_owed = below(u, u_owed);
+        if (!(u->x < hi))
+            r_id = u->left;
+        else
+        {
+            right = Policy::combine(right, Policy::combine(agg_of(u->left, r_owed), Policy::lift(u->x, value_of(u, u_owed))));
+            r_id = u->right;
+        }
+    }
+    return Policy::combine(Policy::combine(left, Policy::lift(v->x, value_of(v, owed))), right);
+}
+
+template<typename Key, typename Data, typename Policy>
+void treap<Key, Data, Policy>::apply(const Key &lo, const Key &hi, const tag_type &tag)
+{
+    static_assert(!std::is_void_v<Policy>, "apply needs an augmentation policy");
+    if (!(lo < hi))
+        return;
+    auto [l_id, mr_id] = split(root_id, lo, true);
+    auto [m_id, r_id]  = split(mr_id, hi, true);
+    if (m_id != -1)
+        add_tag(m_id, tag);
+    root_id = merge(merge(l_id, m_id), r_id);
+    TREAP_CHECK(root_id);
+}
+
+template<typename Key, typename Data, typename Policy>
+bool treap<Key, Data, Policy>::graph_check(size_t id, std::set<size_t> &S) const
 {
     if (id == -1)
         return true;
@@ -578,8 +1066,8 @@ bool treap<Key, Data>::graph_check(size_t id, std::set<size_t> &S) const
     return true;
 }
 
-template<typename Key, typename Data>
-void treap<Key, Data>::print_graph(std::ostream &out, size_t id) const
+template<typename Key, typename Data, typename Policy>
+void treap<Key, Data, Policy>::print_graph(std::ostream &out, size_t id) const
 {
     assert(id != -1);
     Node *v = pool.get(id);
@@ -598,8 +1086,62 @@ void treap<Key, Data>::print_graph(std::ostream &out, size_t id) const
 }
 
 
-template<typename Key, typename Data>
-size_t treap<Key, Data>::merge(size_t tl_id, size_t tr_id)
+template<typename Key, typename Data, typename Policy>
+size_t treap<Key, Data, Policy>::merge(size_t tl_id, size_t tr_id)
+{
+    #ifdef TREAP_RECURSIVE_SPLIT_MERGE
+    return merge_recursive(tl_id, tr_id);
+    #else
+    TREAP_CHECK(tl_id);
+    TREAP_CHECK(tr_id);
+    size_t root = -1;
+    size_t owner = -1;                              // node whose child slot takes the next winner
+    bool   to_right = false;
+    while (tl_id != -1 && tr_id != -1)
+    {
+        Node *tl = push(tl_id);
+        Node *tr = push(tr_id);
+        size_t win_id;
+        bool   win_right;                           // which child of the winner is merged next
+        if (tl->prior < tr->prior)
+        {
+            win_id = tl_id;
+            tl_id = tl->right;
+            win_right = true;
+        }
+        else
+        {
+            win_id = tr_id;
+            tr_id = tr->left;
+            win_right = false;
+        }
+
+        if (owner == -1)
+            root = win_id;
+        else if (to_right)
+            pool.get(owner)->right = win_id;
+        else
+            pool.get(owner)->left = win_id;
+        pool.get(win_id)->parent = owner;
+        to_right = win_right;
+        owner = win_id;
+    }
+
+    size_t rest = (tl_id != -1 ? tl_id : tr_id);
+    if (owner == -1)
+        return rest;
+    if (to_right)
+        pool.get(owner)->right = rest;
+    else
+        pool.get(owner)->left = rest;
+    update_path(owner);
+    TREAP_CHECK(root);
+    return root;
+    #endif
+}
+
+template<typename Key, typename Data, typename Policy>
+size_t treap<Key, Data, Policy>::merge_recursive(size_t tl_id, size_t tr_id)
 {
     TREAP_CHECK(tl_id);
     TREAP_CHECK(tr_id);
@@ -607,34 +1149,83 @@ size_t treap<Key, Data>::merge(size_t tl_id, size_t tr_id)
         return tr_id;
     if (tr_id == -1)
         return tl_id;
-    Node *tl = pool.get(tl_id);
-    Node *tr = pool.get(tr_id);
+    Node *tl = push(tl_id);
+    Node *tr = push(tr_id);
     if (tl->prior < tr->prior)
     {
-        tl->right = merge(tl->right, tr_id);
+        tl->right = merge_recursive(tl->right, tr_id);
         update(tl_id);
         TREAP_CHECK(tl_id);
         return tl_id;
     }
     else
     {
-        tr->left = merge(tl_id, tr->left);
+        tr->left = merge_recursive(tl_id, tr->left);
         update(tr_id);
         TREAP_CHECK(tr_id);
         return tr_id;
     }
 }
 
-template<typename Key, typename Data>
-std::pair<size_t, size_t> treap<Key, Data>::split(size_t t_id, Key k)
+template<typename Key, typename Data, typename Policy>
+std::pair<size_t, size_t> treap<Key, Data, Policy>::split(size_t t_id, Key k, bool strict)
+{
+    #ifdef TREAP_RECURSIVE_SPLIT_MERGE
+    return split_recursive(t_id, k, strict);
+    #else
+    size_t l_root = -1, r_root = -1;
+    size_t l_last = -1, r_last = -1;                // rightmost spine end of the left part, leftmost of the right one
+    while (t_id != -1)
+    {
+        Node *t = push(t_id);
+        if (strict ? t->x < k : t->x <= k)
+        {
+            if (l_last == -1)
+                l_root = t_id;
+            else
+                pool.get(l_last)->right = t_id;
+            t->parent = l_last;
+            l_last = t_id;
+            t_id = t->right;
+        }
+        else
+        {
+            if (r_last == -1)
+                r_root = t_id;
+            else
+                pool.get(r_last)->left = t_id;
+            t->parent = r_last;
+            r_last = t_id;
+            t_id = t->left;
+        }
+    }
+
+    if (l_last != -1)
+    {
+        pool.get(l_last)->right = -1;
+        update_path(l_last);
+    }
+    if (r_last != -1)
+    {
+        pool.get(r_last)->left = -1;
+        update_path(r_last);
+    }
+    TREAP_CHECK(l_root);
+    TREAP_CHECK(r_root);
+    return {l_root, r_root};
+    #endif
+}
+
+template<typename Key, typename Data, typename Policy>
+std::pair<size_t, size_t> treap<Key, Data, Policy>::split_recursive(size_t t_id, Key k, bool strict)
 {
     if (t_id == -1)
         return {-1, -1};
-    Node *t = pool.get(t_id);
+    Node *t = push(t_id);
 
-    if (t->x <= k)
+    if (strict ? t->x < k : t->x <= k)
     {
-        auto [tl_id, tr_id] = split(t->right, k);
+        auto [tl_id, tr_id] = split_recursive(t->right, k, strict);
         t->right = tl_id;
         update(t_id);
         if (tr_id != -1)
@@ -646,7 +1237,7 @@ std::pair<size_t, size_t> treap<Key, Data>::split(size_t t_id, Key k)
     }
     else
     {
-        auto [tl_id, tr_id] = split(t->left, k);
+        auto [tl_id, tr_id] = split_recursive(t->left, k, strict);
         t->left = tr_id;
         update(t_id);
         if (tl_id != -1)
@@ -658,8 +1249,19 @@ std::pair<size_t, size_t> treap<Key, Data>::split(size_t t_id, Key k)
     }
 }
 
-template<typename Key, typename Data>
-void treap<Key, Data>::update(size_t id)
+template<typename Key, typename Data, typename Policy>
+size_t treap<Key, Data, Policy>::new_node(Key x, Data val, size_t prior)
+{
+    size_t id = pool.alloc();
+    assert(id != -1);
+    Node *v = pool.get(id);
+    *v = Node(x, std::move(val));                   // a reused slot still holds its old links
+    v->prior = prior;
+    return id;
+}
+
+template<typename Key, typename Data, typename Policy>
+void treap<Key, Data, Policy>::update(size_t id)
 {
     assert(id != -1);
 
@@ -677,10 +1279,108 @@ void treap<Key, Data>::update(size_t id)
         v->size += tr->size;
         tr->parent = id;
     }
+    if constexpr (!std::is_void_v<Policy>)
+        v->aug.agg = Policy::combine(Policy::combine(getAgg(v->left), Policy::lift(v->x, v->val)), getAgg(v->right));
+}
+
+template<typename Key, typename Data, typename Policy>
+typename treap<Key, Data, Policy>::Node* treap<Key, Data, Policy>::push(size_t id) const
+{
+    Node *v = pool.get(id);
+    if constexpr (!std::is_void_v<Policy>)
+    {
+        if (v->aug.tagged)
+        {
+            if (v->left != -1)
+                add_tag(v->left, v->aug.tag);
+            if (v->right != -1)
+                add_tag(v->right, v->aug.tag);
+            v->aug.tagged = false;
+        }
+    }
+    return v;
+}
+
+template<typename Key, typename Data, typename Policy>
+void treap<Key, Data, Policy>::add_tag(size_t id, const tag_type &tag) const
+{
+    Node *v = pool.get(id);
+    Policy::apply(v->val, tag);
+    Policy::apply(v->aug.agg, tag, v->size);
+    if (v->aug.tagged)
+        Policy::compose(v->aug.tag, tag);
+    else
+    {
+        v->aug.tag = tag;
+        v->aug.tagged = true;
+    }
+}
+
+template<typename Key, typename Data, typename Policy>
+typename treap<Key, Data, Policy>::Node* treap<Key, Data, Policy>::settle(size_t id) const
+{
+    assert(id != -1);
+    if constexpr (!std::is_void_v<Policy>)
+    {
+        // Only the part of the path below the topmost tagged ancestor has anything to push
+        size_t top = -1;
+        for (size_t p = pool.get(id)->parent; p != -1; p = pool.get(p)->parent)
+            if (pool.get(p)->aug.tagged)
+                top = p;
+        const Key &x = pool.get(id)->x;
+        for (size_t u = top; u != -1 && u != id; )
+        {
+            Node *w = push(u);
+            u = (x < w->x ? w->left : w->right);
+        }
+    }
+    return pool.get(id);
+}
+
+template<typename Key, typename Data, typename Policy>
+typename treap<Key, Data, Policy>::pending_tag treap<Key, Data, Policy>::below(const Node *v, const pending_tag &owed) const
+{
+    if (!v->aug.tagged)
+        return owed;
+    pending_tag result{v->aug.tag, true};           // v's own tag is older than anything above it
+    if (owed.tagged)
+        Policy::compose(result.tag, owed.tag);
+    return result;
+}
+
+template<typename Key, typename Data, typename Policy>
+Data treap<Key, Data, Policy>::value_of(const Node *v, const pending_tag &owed) const
+{
+    Data val = v->val;
+    if (owed.tagged)
+        Policy::apply(val, owed.tag);
+    return val;
+}
+
+template<typename Key, typename Data, typename Policy>
+typename treap<Key, Data, Policy>::agg_type treap<Key, Data, Policy>::agg_of(size_t id, const pending_tag &owed) const
+{
+    if (id == -1)
+        return Policy::identity();
+    const Node *v = pool.get(id);
+    agg_type agg = v->aug.agg;
+    if (owed.tagged)
+        Policy::apply(agg, owed.tag, v->size);
+    return agg;
+}
+
+template<typename Key, typename Data, typename Policy>
+void treap<Key, Data, Policy>::update_path(size_t id)
+{
+    while (id != -1)
+    {
+        update(id);
+        id = pool.get(id)->parent;
+    }
 }
 
-template<typename Key, typename Data>
-size_t treap<Key, Data>::min_vert(size_t v_id) const
+template<typename Key, typename Data, typename Policy>
+size_t treap<Key, Data, Policy>::min_vert(size_t v_id) const
 {
     if (v_id == -1)
         return -1;
@@ -690,8 +1390,8 @@ size_t treap<Key, Data>::min_vert(size_t v_id) const
     return v_id;
 }
 
-template<typename Key, typename Data>
-void treap<Key, Data>::print(std::ostream &out, size_t id) const
+template<typename Key, typename Data, typename Policy>
+void treap<Key, Data, Policy>::print(std::ostream &out, size_t id) const
 {
     TREAP_CHECK(id);
     if (id == -1) return;
@@ -703,8 +1403,8 @@ void treap<Key, Data>::print(std::ostream &out, size_t id) const
     print(out, v->right);
 }
 
-template<typename Key, typename Data>
-size_t treap<Key, Data>::max_vert(size_t v_id) const
+template<typename Key, typename Data, typename Policy>
+size_t treap<Key, Data, Policy>::max_vert(size_t v_id) const
 {
     if (v_id == -1)
         return -1;
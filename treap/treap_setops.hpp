@@ -0,0 +1,249 @@
+#ifndef TREAP_SETOPS_HPP
+#define TREAP_SETOPS_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "treap.hpp"
+#include "../threadpool/threadpool.hpp"
+
+namespace g {
+
+//==========================================
+// Set operations on treaps
+//
+// The smaller operand's nodes are cloned into the larger one's pool, then both trees are combined
+// by recursive split/join (Blelloch and Reid-Miller), which is O(m log(n/m + 1)) expected work.
+// Branches own disjoint nodes and only relink them, so the two recursive calls fork onto the
+// thread pool above a size cutoff. Nodes that drop out are chained through their parent links
+// and freed once the recursion is over. On equal keys the value of the first operand is kept.
+
+template<typename Key, typename Data, typename Policy>
+struct treap_setops
+{
+    using tree_t = treap<Key, Data, Policy>;
+    using Node   = typename tree_t::Node;
+
+    static constexpr size_t PARALLEL_CUTOFF = 4096;
+
+    enum class op { unite, intersect, subtract };
+
+    struct chain {                                  // dropped subtree roots, linked by parent
+        size_t head = -1, tail = -1;
+    };
+
+    tree_t &t;
+    thread_pool *tp;
+
+    Node* node( size_t id ) const { return t.pool.get(id); }
+
+    void drop( chain &c, size_t id ) const
+    {
+        if (id == -1)
+            return;
+        node(id)->parent = -1;
+        if (c.tail == -1)
+            c.head = id;
+        else
+            node(c.tail)->parent = id;
+        c.tail = id;
+    }
+
+    void drop_single( chain &c, size_t id ) const
+    {
+        Node *v = node(id);
+        v->left = v->right = -1;
+        drop(c, id);
+    }
+
+    void concat( chain &a, const chain &b ) const
+    {
+        if (b.head == -1)
+            return;
+        if (a.tail == -1)
+            a.head = b.head;
+        else
+            node(a.tail)->parent = b.head;
+        a.tail = b.tail;
+    }
+
+    // Splits id by k into (< k, node with key k or -1, > k)
+    std::tuple<size_t, size_t, size_t> split3( size_t id, const Key &k ) const
+    {
+        auto [l_id, r_id] = t.split(id, k);
+        if (l_id == -1)
+            return {l_id, size_t(-1), r_id};
+
+        size_t m_id = l_id;
+        while (t.push(m_id)->right != -1)
+            m_id = node(m_id)->right;
+        Node *m = node(m_id);
+        if (m->x != k)
+            return {l_id, size_t(-1), r_id};
+
+        size_t p_id = m->parent;
+        if (p_id == -1)
+            l_id = m->left;
+        else
+            node(p_id)->right = m->left;
+        if (m->left != -1)
+            node(m->left)->parent = p_id;
+        t.update_path(p_id);
+        if (l_id != -1)
+            node(l_id)->parent = -1;
+        return {l_id, m_id, r_id};
+    }
+
+    template<typename FunctionA, typename FunctionB>
+    void fork( size_t work, FunctionA &&a, FunctionB &&b ) const
+    {
+        if (tp && work > PARALLEL_CUTOFF)
+            tp->parallel_invoke(a, b);
+        else {
+            a();
+            b();
+        }
+    }
+
+    // a_first tells whether a comes from the first operand; subtract never swaps, so there it always does
+    size_t run( op o, size_t a, size_t b, bool a_first, chain &dropped ) const
+    {
+        if (a == -1 || b == -1) {
+            switch (o) {
+            case op::unite:
+                return a != -1 ? a : b;
+            case op::intersect:
+                drop(dropped, a != -1 ? a : b);
+                return -1;
+            case op::subtract:
+                drop(dropped, b);
+                return a;
+            }
+        }
+
+        if (o != op::subtract && node(b)->prior < node(a)->prior) {
+            std::swap(a, b);                        // the smaller priority stays on top
+            a_first = !a_first;
+        }
+
+        size_t work = t.getSize(a) + t.getSize(b);
+        t.push(a);
+        size_t a_left = node(a)->left, a_right = node(a)->right;
+        auto [b_left, b_mid, b_right] = split3(b, node(a)->x);
+
+        size_t left = -1, right = -1;
+        chain dropped_left, dropped_right;
+        fork(work,
+             [&]() { left  = run(o, a_left,  b_left,  a_first, dropped_left);  },
+             [&]() { right = run(o, a_right, b_right, a_first, dropped_right); });
+        concat(dropped, dropped_left);
+        concat(dropped, dropped_right);
+
+        bool keep = (o == op::unite || (o == op::intersect) == (b_mid != -1));
+        if (b_mid != -1) {
+            if (keep && !a_first)
+                node(a)->val = std::move(node(b_mid)->val);
+            drop_single(dropped, b_mid);
+        }
+
+        if (!keep) {
+            drop_single(dropped, a);
+            return t.merge(left, right);
+        }
+        Node *v = node(a);
+        v->left = left;
+        v->right = right;
+        v->parent = -1;
+        t.update(a);
+        return a;
+    }
+
+    size_t clone( const tree_t &other, size_t id )
+    {
+        if (id == -1)
+            return -1;
+        const Node &src = *other.pool.get(id);
+        size_t new_id = t.pool.alloc();
+        *t.pool.get(new_id) = src;
+        size_t l_id = clone(other, src.left);
+        size_t r_id = clone(other, src.right);
+        // Same shape, so size and aggregate carry over as they are; recomputing them would miss a
+        // tag the node still owes its children
+        Node *v = t.pool.get(new_id);
+        v->left = l_id;
+        v->right = r_id;
+        v->parent = -1;
+        if (l_id != -1)
+            t.pool.get(l_id)->parent = new_id;
+        if (r_id != -1)
+            t.pool.get(r_id)->parent = new_id;
+        return new_id;
+    }
+
+    void free_chain( const chain &c )
+    {
+        std::vector<size_t> stack;
+        for (size_t id = c.head; id != -1; ) {
+            size_t next = (id == c.tail ? size_t(-1) : node(id)->parent);
+            stack.push_back(id);
+            while (!stack.empty()) {
+                size_t v_id = stack.back();
+                stack.pop_back();
+                Node *v = node(v_id);
+                if (v->left != -1)
+                    stack.push_back(v->left);
+                if (v->right != -1)
+                    stack.push_back(v->right);
+                t.pool.free(v_id);
+            }
+            id = next;
+        }
+    }
+
+    static tree_t apply( op o, tree_t a, tree_t b, thread_pool *tp )
+    {
+        bool a_first = true;
+        if (a.size() < b.size()) {
+            std::swap(a, b);
+            a_first = false;
+        }
+        treap_setops ops{a, tp};
+        size_t b_root = ops.clone(b, b.root_id);
+        chain dropped;
+        a.root_id = (a_first ? ops.run(o, a.root_id, b_root, true, dropped)
+                             : ops.run(o, b_root, a.root_id, true, dropped));
+        if (a.root_id != -1)
+            ops.node(a.root_id)->parent = -1;
+        ops.free_chain(dropped);
+        assert(a.graph_check());
+        return a;
+    }
+};
+
+template<typename Key, typename Data, typename Policy>
+treap<Key, Data, Policy> treap_union( treap<Key, Data, Policy> a, treap<Key, Data, Policy> b, thread_pool *pool = nullptr )
+{
+    using ops = treap_setops<Key, Data, Policy>;
+    return ops::apply(ops::op::unite, std::move(a), std::move(b), pool);
+}
+
+template<typename Key, typename Data, typename Policy>
+treap<Key, Data, Policy> treap_intersection( treap<Key, Data, Policy> a, treap<Key, Data, Policy> b, thread_pool *pool = nullptr )
+{
+    using ops = treap_setops<Key, Data, Policy>;
+    return ops::apply(ops::op::intersect, std::move(a), std::move(b), pool);
+}
+
+// Elements of a whose keys are not in b
+template<typename Key, typename Data, typename Policy>
+treap<Key, Data, Policy> treap_difference( treap<Key, Data, Policy> a, treap<Key, Data, Policy> b, thread_pool *pool = nullptr )
+{
+    using ops = treap_setops<Key, Data, Policy>;
+    return ops::apply(ops::op::subtract, std::move(a), std::move(b), pool);
+}
+
+} // namespace g
+#endif